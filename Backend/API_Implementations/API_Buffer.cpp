@@ -12,6 +12,8 @@
 #include "API_Buffer.h"
 //for memcpy
 #include <cstring>
+//for std::find
+#include <algorithm>
 //add debugging
 #include "../../../GLGE_BG/Debugging/Logging/__BG_SimpleDebug.h"
 
@@ -28,8 +30,11 @@ GLGE::Graphic::Backend::API::Buffer::Buffer(void* data, uint64_t dataSize, Type
         GLGE_ASSERT("Failed to allocate the CPU side data buffer of a graphic buffer", !m_data);
         //store the size of the allocated block
         m_size = dataSize;
+        m_capacity = dataSize;
         //copy the data over
         memcpy(m_data, data, dataSize);
+        //the whole buffer must be uploaded
+        markDirty(0, dataSize);
         //queue an update
         queueUpdate();
     }
@@ -37,6 +42,12 @@ GLGE::Graphic::Backend::API::Buffer::Buffer(void* data, uint64_t dataSize, Type
 
 GLGE::Graphic::Backend::API::Buffer::~Buffer() noexcept
 {
+    //if the buffer is still queued for an update, remove it from the queue
+    if (m_queued.load(std::memory_order_acquire)) {
+        std::unique_lock lock(m_mutex);
+        auto pos = std::find(m_queue.begin(), m_queue.end(), this);
+        if (pos != m_queue.end()) {m_queue.erase(pos);}
+    }
     //if data exists, delete it
     if (m_data) {
         delete[] (uint8_t*)m_data;
@@ -48,12 +59,20 @@ void GLGE::Graphic::Backend::API::Buffer::resize(uint64_t newSize) noexcept
 {
     //make sure this is the only thread that writes to the data
     std::unique_lock lock(m_dataMtx);
-    //allocate the new data
-    void* newData = new uint8_t[newSize](0);
-    GLGE_ASSERT("Failed to allocate the new data for the resizing of a CPU side buffer", !newData);
-    //copy the old data over
-    memcpy(newData, m_data, (m_size > newSize) ? newSize : m_size);
-    m_data = newData;
+    //write-through buffers keep no CPU side storage, the new bytes are cleared on the GPU
+    if (m_writeThrough) {
+        if (newSize > m_size) {addPendingWrite(nullptr, newSize - m_size, m_size);}
+        m_size = newSize;
+        queueUpdate();
+        return;
+    }
+    //make sure the storage is large enough
+    reserveData(newSize, false);
+    //new bytes start zeroed
+    if (newSize > m_size) {memset(((uint8_t*)m_data) + m_size, 0, newSize - m_size);}
+    //the region between the old and the new end changed
+    if (newSize > m_size) {markDirty(m_size, newSize - m_size);}
+    else {markDirty(newSize, m_size - newSize);}
     //store the new size
     m_size = newSize;
     //queue an update
@@ -64,20 +83,164 @@ void GLGE::Graphic::Backend::API::Buffer::append(void* data, uint64_t dataSize)
 {
     //make sure this is the only thread that writes to the data
     std::unique_lock lock(m_dataMtx);
-    //allocate a buffer that is `dataSize` larger than the current block
-    void* newData = new uint8_t[dataSize + m_size];
-    GLGE_ASSERT("Failed to expand the region of a CPU side buffer", !newData);
-    //copy the old data over
-    memcpy(newData, m_data, m_size);
+    //write-through buffers only store the appended bytes
+    if (m_writeThrough) {
+        addPendingWrite(data, dataSize, m_size);
+        m_size += dataSize;
+        queueUpdate();
+        return;
+    }
+    //make sure the storage is large enough, grow geometrically so repeated appends don't copy all data each time
+    reserveData(m_size + dataSize, true);
     //copy the new data
-    memcpy(((uint8_t*)newData) + m_size, data, dataSize);
-    m_data = newData;
+    memcpy(((uint8_t*)m_data) + m_size, data, dataSize);
+    //the appended region changed
+    markDirty(m_size, dataSize);
     //increase the size
     m_size += dataSize;
     //queue an update
     queueUpdate();
 }
 
+void GLGE::Graphic::Backend::API::Buffer::shrinkToFit() noexcept
+{
+    //make sure this is the only thread that writes to the data
+    std::unique_lock lock(m_dataMtx);
+    //check if any storage is unused (write-through buffers may have no storage at all)
+    if (!m_data || (m_capacity == m_size)) {return;}
+
+    //move the data to a storage that is exactly large enough
+    void* newData = m_size ? new uint8_t[m_size] : nullptr;
+    if (m_size) {memcpy(newData, m_data, m_size);}
+    delete[] (uint8_t*)m_data;
+    m_data = newData;
+    m_capacity = m_size;
+}
+
+bool GLGE::Graphic::Backend::API::Buffer::setWriteThrough(bool writeThrough) noexcept
+{
+    //make sure this is the only thread that accesses the data
+    std::unique_lock lock(m_dataMtx);
+    //the CPU side copy can't be restored if data is stored
+    if (!writeThrough && m_writeThrough && m_size) {return false;}
+    //data that was not uploaded yet becomes a pending write, so write-through buffers never hold CPU side storage
+    if (writeThrough && !m_writeThrough && m_data) {
+        for (const DirtyRange& range : m_dirty) {
+            //ranges may reach over the end if the buffer shrunk
+            if (range.start >= m_size) {break;}
+            uint64_t end = std::min(range.end, m_size);
+            addPendingWrite(((uint8_t*)m_data) + range.start, end - range.start, range.start);
+        }
+        m_dirty.clear();
+        delete[] (uint8_t*)m_data;
+        m_data = nullptr;
+        m_capacity = 0;
+    }
+    m_writeThrough = writeThrough;
+    return true;
+}
+
+void GLGE::Graphic::Backend::API::Buffer::addPendingWrite(const void* data, uint64_t size, uint64_t offset) noexcept
+{
+    //empty writes never change anything
+    if (size == 0) {return;}
+    //zeroed regions don't store any bytes
+    if (!data) {
+        m_pendingWrites.push_back({offset, size, CLEAR});
+        return;
+    }
+    //store the bytes behind all other pending bytes
+    uint64_t start = m_pendingBytes.size();
+    m_pendingBytes.insert(m_pendingBytes.end(), (const uint8_t*)data, ((const uint8_t*)data) + size);
+    m_pendingWrites.push_back({offset, size, start});
+}
+
+void GLGE::Graphic::Backend::API::Buffer::reserveData(uint64_t capacity, bool geometric) noexcept
+{
+    //only grow
+    if (capacity <= m_capacity) {return;}
+    //when growing geometrically, at least double the capacity
+    if (geometric && (capacity < (m_capacity * 2))) {capacity = m_capacity * 2;}
+
+    //allocate the new storage
+    void* newData = new uint8_t[capacity];
+    GLGE_ASSERT("Failed to allocate the new data for the resizing of a CPU side buffer", !newData);
+    //copy the old data over and free the old storage
+    if (m_data) {
+        memcpy(newData, m_data, m_size);
+        delete[] (uint8_t*)m_data;
+    }
+    m_data = newData;
+    m_capacity = capacity;
+}
+
+void GLGE::Graphic::Backend::API::Buffer::copy(Buffer* src, uint64_t srcOffset, uint64_t dstOffset, uint64_t size) noexcept
+{
+    //copy the CPU side data
+    copyData(src, srcOffset, dstOffset, size);
+    //queue an update
+    queueUpdate();
+}
+
+void GLGE::Graphic::Backend::API::Buffer::copyData(Buffer* src, uint64_t srcOffset, uint64_t dstOffset, uint64_t size) noexcept
+{
+    //copying inside the same buffer only needs a single lock
+    if (src == this) {
+        //make sure this is the only thread that writes to the data
+        std::unique_lock lock(m_dataMtx);
+        //sanity check the regions
+        if (!m_data || ((srcOffset + size) > m_size) || ((dstOffset + size) > m_size)) {return;}
+        memcpy(((uint8_t*)m_data) + dstOffset, ((uint8_t*)m_data) + srcOffset, size);
+        markDirty(dstOffset, size);
+        return;
+    }
+
+    //the source is only read
+    std::shared_lock srcLock(src->m_dataMtx);
+    std::unique_lock lock(m_dataMtx);
+    //sanity check the regions
+    if (!m_data || !src->m_data || ((srcOffset + size) > src->m_size) || ((dstOffset + size) > m_size)) {return;}
+    memcpy(((uint8_t*)m_data) + dstOffset, ((uint8_t*)src->m_data) + srcOffset, size);
+    markDirty(dstOffset, size);
+}
+
+void GLGE::Graphic::Backend::API::Buffer::markDirty(uint64_t offset, uint64_t size) noexcept
+{
+    //don't let scattered writes grow the list without bound, a single larger range is cheaper to upload at that point
+    if (!addDirtyRange(m_dirty, offset, size, MAX_DIRTY_RANGES)) {
+        m_dirty.front().end = m_dirty.back().end;
+        m_dirty.resize(1);
+    }
+}
+
+bool GLGE::Graphic::Backend::API::Buffer::addDirtyRange(std::vector<DirtyRange>& ranges, uint64_t offset, uint64_t size, uint64_t maxRanges) noexcept
+{
+    //empty regions never change anything
+    if (size == 0) {return true;}
+    uint64_t end = offset + size;
+
+    //find the first range that ends at or behind the start of the new range
+    auto first = std::lower_bound(ranges.begin(), ranges.end(), offset, 
+                                  [](const DirtyRange& range, uint64_t idx) {return range.end < idx;});
+    //find the first range that starts behind the end of the new range
+    //all ranges in between touch the new range and are merged with it
+    auto last = first;
+    while ((last != ranges.end()) && (last->start <= end)) {++last;}
+
+    if (first == last) {
+        //nothing to merge with, so insert the new range
+        ranges.insert(first, {offset, end});
+    } else {
+        //grow the first touching range so it covers all touching ranges
+        first->start = std::min(first->start, offset);
+        first->end = std::max((last-1)->end, end);
+        ranges.erase(first+1, last);
+    }
+
+    //report if the list grew too large
+    return ranges.size() <= maxRanges;
+}
+
 void GLGE::Graphic::Backend::API::Buffer::queueUpdate() noexcept {
     //only queue an update if none is queued
     if (!m_queued.load(std::memory_order_acquire)) {
@@ -83,9 +83,23 @@ public:
      */
     virtual void write(void* data, uint64_t dataSize, uint64_t offset) noexcept = 0;
 
+    /**
+     * @brief copy a region of another buffer (or this buffer) into this buffer
+     * 
+     * The regions must not overlap if both buffers are the same. 
+     * 
+     * @param src the buffer to copy from
+     * @param srcOffset the offset into the source buffer in bytes
+     * @param dstOffset the offset into this buffer in bytes
+     * @param size the amount of bytes to copy
+     */
+    virtual void copy(Buffer* src, uint64_t srcOffset, uint64_t dstOffset, uint64_t size) noexcept;
+
     /**
      * @brief change the size of the buffer to a new size
      * 
+     * The CPU side storage is only re-allocated if the new size is larger than the capacity. 
+     * 
      * @warning this may truncate the stored data
      * 
      * @param newSize the new size for the buffer
@@ -95,11 +109,18 @@ public:
     /**
      * @brief add some data to the currently stored data
      * 
+     * The capacity grows geometrically, so appending is amortized constant time per byte. 
+     * 
      * @param data the data to add to the currently stored data
      * @param dataSize the size of the data to append
      */
     void append(void* data, uint64_t dataSize) noexcept;
 
+    /**
+     * @brief release all CPU side storage that is not used by the data
+     */
+    void shrinkToFit() noexcept;
+
     /**
      * @brief Get the Type of the buffer
      * 
@@ -110,9 +131,30 @@ public:
     /**
      * @brief Get the Raw data of the buffer
      * 
-     * @return const void* a pointer to the raw data
+     * @return const void* a pointer to the raw data (nullptr for write-through buffers)
+     */
+    inline void* getRaw() const noexcept {return m_writeThrough ? nullptr : m_data;}
+
+    /**
+     * @brief Set if the buffer writes directly to the GPU without keeping a CPU side copy of the data
+     * 
+     * Write-through buffers only keep the bytes written since the last update. Those writes are staged and 
+     * recorded as GPU copies during the next update, so they are ordered behind all frames that were already 
+     * submitted. Growing the buffer never allocates CPU side storage, the new bytes are cleared on the GPU. 
+     * A buffer can always become write-through, but it can only stop being write-through while it is empty. 
+     * 
+     * @param writeThrough true : don't keep a CPU side copy | false : keep a CPU side copy
+     * @return true : the mode was changed
+     * @return false : the buffer is not empty, so the CPU side copy can't be restored
      */
-    inline void* getRaw() const noexcept {return m_data;}
+    bool setWriteThrough(bool writeThrough) noexcept;
+
+    /**
+     * @brief check if the buffer writes directly to the GPU without keeping a CPU side copy of the data
+     * 
+     * @return true : the buffer is write-through | false : the buffer keeps a CPU side copy
+     */
+    inline bool isWriteThrough() const noexcept {return m_writeThrough;}
 
     /**
      * @brief Get the Size of the buffer's data
@@ -121,8 +163,50 @@ public:
      */
     inline uint64_t getSize() const noexcept {return m_size;}
 
+    /**
+     * @brief Get the Capacity of the CPU side storage
+     * 
+     * @return uint64_t the amount of bytes the buffer can hold without re-allocating
+     */
+    inline uint64_t getCapacity() const noexcept {return m_capacity;}
+
+    /**
+     * @brief Get the amount of bytes that were uploaded to the GPU during the last tick
+     * 
+     * @return uint64_t the amount of uploaded bytes
+     */
+    inline static uint64_t getUploadedBytes() noexcept {return m_lastUploadedBytes.load(std::memory_order_relaxed);}
+
+    /**
+     * @brief store a range of bytes that changed since the last update
+     */
+    struct DirtyRange {
+        //the first byte that changed
+        uint64_t start;
+        //the byte after the last byte that changed
+        uint64_t end;
+    };
+
+    /**
+     * @brief add a range to a sorted list of non-overlapping dirty ranges
+     * 
+     * Ranges that touch or overlap the new range are merged with it. 
+     * 
+     * @param ranges the sorted list of ranges to add the range to
+     * @param offset the offset of the changed region in bytes
+     * @param size the size of the changed region in bytes
+     * @param maxRanges the maximum amount of ranges the list may hold
+     * @return true : the range was added | false : the list now holds more than `maxRanges` ranges
+     */
+    static bool addDirtyRange(std::vector<DirtyRange>& ranges, uint64_t offset, uint64_t size, uint64_t maxRanges) noexcept;
+
 protected:
 
+    /**
+     * @brief define how many separate dirty ranges are tracked before they are merged into a single range
+     */
+    inline static constexpr uint64_t MAX_DIRTY_RANGES = 64;
+
     /**
      * @brief update the GPU side of the buffer
      */
@@ -133,6 +217,64 @@ protected:
      */
     void queueUpdate() noexcept;
 
+    /**
+     * @brief copy a region of the CPU side data of another buffer (or this buffer) into this buffer without queueing an update
+     * 
+     * @param src the buffer to copy from
+     * @param srcOffset the offset into the source buffer in bytes
+     * @param dstOffset the offset into this buffer in bytes
+     * @param size the amount of bytes to copy
+     */
+    void copyData(Buffer* src, uint64_t srcOffset, uint64_t dstOffset, uint64_t size) noexcept;
+
+    /**
+     * @brief mark a region of the buffer as changed so the next update uploads it
+     * 
+     * @warning the data mutex must be locked by the caller
+     * 
+     * @param offset the offset of the changed region in bytes
+     * @param size the size of the changed region in bytes
+     */
+    void markDirty(uint64_t offset, uint64_t size) noexcept;
+
+    /**
+     * @brief make sure the CPU side storage can hold a specific amount of bytes
+     * 
+     * @warning the data mutex must be locked by the caller
+     * 
+     * @param capacity the minimal capacity in bytes
+     * @param geometric true : grow to at least double the current capacity | false : grow to exactly the requested capacity
+     */
+    void reserveData(uint64_t capacity, bool geometric) noexcept;
+
+    /**
+     * @brief store a write to a write-through buffer that is applied during the next update
+     */
+    struct PendingWrite {
+        //the offset of the written region in bytes
+        uint64_t offset;
+        //the size of the written region in bytes
+        uint64_t size;
+        //the first byte of the data in the pending bytes (`CLEAR` if the region is zeroed)
+        uint64_t start;
+    };
+
+    /**
+     * @brief the start of a pending write that zeroes its region instead of writing data
+     */
+    inline static constexpr uint64_t CLEAR = UINT64_MAX;
+
+    /**
+     * @brief store a write to a write-through buffer until the next update
+     * 
+     * @warning the data mutex must be locked by the caller
+     * 
+     * @param data the data to write or `nullptr` to zero the region
+     * @param size the size of the region in bytes
+     * @param offset the offset of the region in bytes
+     */
+    void addPendingWrite(const void* data, uint64_t size, uint64_t offset) noexcept;
+
     //add the instance class as a friend
     friend class Instance;
 
@@ -142,15 +284,29 @@ protected:
     void* m_data = nullptr;
     //store the size in bytes of the data
     uint64_t m_size = 0;
+    //store the size in bytes of the CPU side storage
+    uint64_t m_capacity = 0;
+    //store if the buffer keeps no CPU side copy of the data
+    bool m_writeThrough = false;
     //store a mutex to protect the own data
     std::shared_mutex m_dataMtx;
     //store if the buffer is queued for update
     std::atomic_bool m_queued{false};
+    //store the sorted, non-overlapping ranges of bytes that changed since the last update
+    std::vector<DirtyRange> m_dirty;
+    //store the writes to a write-through buffer since the last update in the order they happened
+    std::vector<PendingWrite> m_pendingWrites;
+    //store the bytes of all pending writes
+    std::vector<uint8_t> m_pendingBytes;
 
     //store a list of all queued buffers
     inline static std::vector<Buffer*> m_queue;
     //store a mutex to make the buffer thread safe
     inline static std::mutex m_mutex;
+    //store the amount of bytes uploaded during the current tick
+    inline static std::atomic_uint64_t m_uploadedBytes{0};
+    //store the amount of bytes uploaded during the last tick
+    inline static std::atomic_uint64_t m_lastUploadedBytes{0};
 
 };
 
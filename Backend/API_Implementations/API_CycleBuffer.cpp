@@ -13,10 +13,23 @@
 //add the full backend
 #include "AllImplementations.h"
 #include "../Instance.h"
+//add debugging
+#include "../../../GLGE_BG/Debugging/Logging/__BG_SimpleDebug.h"
+//add std::find
+#include <algorithm>
+//add std::this_thread::yield
+#include <thread>
 
 //add the API namespace locally
 using namespace GLGE::Graphic::Backend::API;
 
+//only track mappings in debug
+#if GLGE_BG_DEBUG
+//store the cycle buffers the calling thread has mapped sections of
+//exclusive access to one of them would wait for the own mapping forever
+static thread_local std::vector<const CycleBuffer*> __threadMappings;
+#endif
+
 inline static CycleBufferBackend* createBackend(CycleBuffer* buffer, uint8_t idx) {
     //switch over the API
     switch (GLGE::Graphic::Backend::INSTANCE.getAPI())
@@ -38,6 +51,8 @@ CycleBuffer::CycleBuffer(void* data, uint64_t size, Buffer::Type type, uint8_t b
     //create the buffer
     m_data = calloc(m_size, 1);
     if (data) {memcpy(m_data, data, size);}
+    //create the storage for the written ranges
+    m_pending = new Buffer::DirtyRange[MAX_PENDING_RANGES];
     //create all the buffer backends
     for (uint8_t i = 0; i < cm_usedBuffers; ++i) {
         m_backends[i] = createBackend(this, i);
@@ -62,6 +77,16 @@ CycleBuffer::~CycleBuffer()
                 break;
             }
         }
+        //also remove it from the dirty list
+        if (m_tickQueued.load(std::memory_order_acquire)) {
+            std::unique_lock dirtyLock(s_dirtyMtx);
+            for (size_t i = 0; i < s_dirty.size(); ++i) {
+                if (s_dirty[i] == this) {
+                    s_dirty.erase(s_dirty.begin() + i);
+                    break;
+                }
+            }
+        }
     }
     //clean up the buffers
     for (uint8_t i = 0; i < cm_usedBuffers; ++i) {
@@ -71,12 +96,17 @@ CycleBuffer::~CycleBuffer()
     //clean up the data
     free(m_data);
     m_data = nullptr;
+    delete[] m_pending;
+    m_pending = nullptr;
 }
 
-void CycleBuffer::tick() noexcept
+bool CycleBuffer::tick() noexcept
 {
-    //thread safety
-    std::unique_lock lock(m_mtx);
+    //writes must not change the data while it is synced
+    //running writes are not waited for, the buffer is just ticked again with the next tick
+    if (!tryLockExclusive()) {return false;}
+    //pass the written ranges to the backends
+    flushPendingRanges();
     //if only one buffer exists, just sync it
     if (cm_usedBuffers == 1)
     {
@@ -85,6 +115,9 @@ void CycleBuffer::tick() noexcept
     } else {
         //else, update all buffers but not the one being consumed by the GPU
 
+        //the outgoing buffer may have been bound for many frames if the buffer was not ticked in between, 
+        //so it is in use until the frame that is recorded now finished
+        getCurrentGPUBackend<API::CycleBufferBackend>()->markInUse();
         //advance the GPU index
         m_gpuBuff.store((m_gpuBuff.load(std::memory_order_acquire) + 1) % cm_usedBuffers, std::memory_order_release);
         //mark the new buffer as in use
@@ -95,37 +128,177 @@ void CycleBuffer::tick() noexcept
             m_backends[i]->syncCPU(false);
         }
     }
+
+    //check if every backend holds the current data
+    uint32_t version = m_version.load(std::memory_order_acquire);
+    bool synced = true;
+    for (uint8_t i = 0; i < cm_usedBuffers; ++i) {
+        if (m_backends[i]->m_version != version) {synced = false; break;}
+    }
+    //writes may continue
+    unlockExclusive();
+    return synced;
+}
+
+void CycleBuffer::beginWrite() noexcept
+{
+    //a single atomic operation registers the writer if no thread has exclusive access
+    while (m_gate.fetch_add(1, std::memory_order_acquire) & GATE_EXCLUSIVE) {
+        //another thread has exclusive access, so undo the registration and wait
+        m_gate.fetch_sub(1, std::memory_order_relaxed);
+        s_writeWaits.fetch_add(1, std::memory_order_relaxed);
+        uint32_t spins = 0;
+        while (m_gate.load(std::memory_order_relaxed) & GATE_EXCLUSIVE) {gateBackoff(spins);}
+    }
+}
+
+void CycleBuffer::lockExclusive() noexcept
+{
+    //only in debug
+    #if GLGE_BG_DEBUG
+        //sanity check that the calling thread does not wait for its own mapping
+        GLGE_DEBUG_ASSERT("Setting or re-sizing a cycle buffer on a thread that has a section of it mapped", 
+                          std::find(__threadMappings.begin(), __threadMappings.end(), this) != __threadMappings.end());
+    #endif
+    //only a single thread may have exclusive access
+    uint32_t spins = 0;
+    while (m_gate.fetch_or(GATE_EXCLUSIVE, std::memory_order_acquire) & GATE_EXCLUSIVE) {
+        while (m_gate.load(std::memory_order_relaxed) & GATE_EXCLUSIVE) {gateBackoff(spins);}
+    }
+    //wait for all running writes to finish, new writes can't start anymore
+    if (m_gate.load(std::memory_order_acquire) != GATE_EXCLUSIVE) {
+        s_exclusiveWaits.fetch_add(1, std::memory_order_relaxed);
+        spins = 0;
+        while (m_gate.load(std::memory_order_acquire) != GATE_EXCLUSIVE) {gateBackoff(spins);}
+    }
+}
+
+void CycleBuffer::gateBackoff(uint32_t& spins) noexcept
+{
+    //short waits spin, as the gate is usually only held for a memcpy
+    if (spins < GATE_SPIN_LIMIT) {
+        _mm_pause();
+        ++spins;
+        return;
+    }
+    //longer waits (like a mapping that is held for a while) give the core to other threads
+    std::this_thread::yield();
+}
+
+bool CycleBuffer::tryLockExclusive() noexcept
+{
+    //exclusive access is only granted if no writer is running and no other thread has exclusive access
+    uint32_t expected = 0;
+    if (m_gate.compare_exchange_strong(expected, GATE_EXCLUSIVE, std::memory_order_acquire, std::memory_order_relaxed)) {return true;}
+    //count the skipped access like a waiting one
+    s_exclusiveWaits.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void CycleBuffer::flushPendingRanges() noexcept
+{
+    //get the amount of written ranges and reset the storage
+    uint32_t count = m_pendingCount.exchange(0, std::memory_order_acquire);
+    if (count == 0) {return;}
+
+    //if the storage overflowed, not all ranges are known
+    if (count > MAX_PENDING_RANGES) {
+        for (uint8_t i = 0; i < cm_usedBuffers; ++i) {m_backends[i]->markAllDirty();}
+        return;
+    }
+    //every backend only needs to copy the written regions
+    for (uint32_t r = 0; r < count; ++r) {
+        for (uint8_t i = 0; i < cm_usedBuffers; ++i) 
+        {m_backends[i]->markDirty(m_pending[r].start, m_pending[r].end - m_pending[r].start);}
+    }
+}
+
+void CycleBuffer::queueTick() noexcept
+{
+    //only queue the buffer once
+    if (m_tickQueued.exchange(true, std::memory_order_acq_rel)) {return;}
+    //thread safety
+    std::unique_lock lock(s_dirtyMtx);
+    s_dirty.push_back(this);
 }
 
 void CycleBuffer::set(void* data, uint64_t size) noexcept
 {
     //thread safety
-    std::unique_lock lock(m_mtx);
+    lockExclusive();
     //check if the size changed
     if (size != m_size) {
         //if it did, resize the buffer
-        resize(size);
+        resizeData(size);
     }
     //then, store the data
     memcpy(m_data, data, m_size);
+    //every backend has to copy the whole buffer
+    for (uint8_t i = 0; i < cm_usedBuffers; ++i) {m_backends[i]->markAllDirty();}
     //update the version
     m_version.fetch_add(1, std::memory_order_acq_rel);
+    unlockExclusive();
+    //the backends need to be synced
+    queueTick();
 }
 
 void CycleBuffer::write(void* data, uint64_t size, uint64_t offset) noexcept
 {
-    //thread safety
-    std::unique_lock lock(m_mtx);
+    //get access to the section, other writers are not blocked
+    void* section = map(offset, size);
+    if (!section) {return;}
     //write at the requested position
-    memcpy((uint8_t*)m_data + offset, data, size);
+    memcpy(section, data, size);
+    //publish the change
+    unmap(offset, size);
+}
+
+void* CycleBuffer::map(uint64_t offset, uint64_t size) noexcept
+{
+    //register as a writer, other writers are not blocked
+    beginWrite();
+    //quick bounds check
+    if ((offset + size) > m_size) {endWrite(); return nullptr;}
+    //only in debug
+    #if GLGE_BG_DEBUG
+        //remember the mapping of the calling thread
+        __threadMappings.push_back(this);
+    #endif
+    //the writer stays registered until the section is unmapped
+    return (uint8_t*)m_data + offset;
+}
+
+void CycleBuffer::unmap(uint64_t offset, uint64_t size) noexcept
+{
+    //store the written range for the next tick
+    //the range is only lost if the storage is full, and then the next tick copies everything
+    uint32_t idx = m_pendingCount.fetch_add(1, std::memory_order_relaxed);
+    if (idx < MAX_PENDING_RANGES) {m_pending[idx] = {offset, offset + size};}
     //update the version
     m_version.fetch_add(1, std::memory_order_acq_rel);
+    //only in debug
+    #if GLGE_BG_DEBUG
+        //the calling thread no longer holds the mapping
+        auto pos = std::find(__threadMappings.begin(), __threadMappings.end(), this);
+        if (pos != __threadMappings.end()) {__threadMappings.erase(pos);}
+    #endif
+    endWrite();
+    //the backends need to be synced
+    queueTick();
 }
 
 void CycleBuffer::resize(uint64_t size) noexcept
 {
     //thread safety
-    std::unique_lock lock(m_mtx);
+    lockExclusive();
+    resizeData(size);
+    unlockExclusive();
+    //the backends need to be re-sized
+    queueTick();
+}
+
+void CycleBuffer::resizeData(uint64_t size) noexcept
+{
     //create the new buffer
     void* newBuff = calloc(size, 1);
     //copy over the maximum of data
@@ -68,19 +68,56 @@ public:
     virtual void syncCPU(bool force) noexcept = 0;
 
     /**
-     * @brief mark that this buffer is now the GPU consumed buffer
+     * @brief mark that this buffer is used by the GPU in the frame that is recorded now
+     * 
+     * This is called when the buffer becomes the GPU consumed buffer and again when it stops being it. 
      * @warning this should only be called from the main thread during the main graphic update
      */
     virtual void markInUse() noexcept = 0;
 
 protected:
 
+    /**
+     * @brief define how many separate dirty ranges a backend tracks before it falls back to a full copy
+     */
+    inline static constexpr uint64_t MAX_DIRTY_RANGES = 32;
+
+    /**
+     * @brief mark a region of the cycle buffer as changed since the last sync of this backend
+     * @warning the caller must have exclusive access to the cycle buffer
+     * 
+     * @param offset the offset of the changed region in bytes
+     * @param size the size of the changed region in bytes
+     */
+    inline void markDirty(uint64_t offset, uint64_t size) noexcept {
+        //a full copy already covers the region
+        if (m_fullSync) {return;}
+        //fall back to a full copy if the writes are too scattered
+        if (!Buffer::addDirtyRange(m_dirty, offset, size, MAX_DIRTY_RANGES)) {markAllDirty();}
+    }
+
+    /**
+     * @brief mark the whole cycle buffer as changed since the last sync of this backend
+     * @warning the caller must have exclusive access to the cycle buffer
+     */
+    inline void markAllDirty() noexcept {
+        m_dirty.clear();
+        m_fullSync = true;
+    }
+
+    //the cycle buffer marks the dirty regions
+    friend class CycleBuffer;
+
     //store the cycle buffer the buffer belongs to
     CycleBuffer* m_cBuff = nullptr;
     //store the index of the buffer
     uint8_t m_idx = UINT8_MAX;
     //store the version the buffer was updated last
     uint32_t m_version = 0;
+    //store if the whole buffer must be copied on the next sync
+    bool m_fullSync = false;
+    //store the sorted ranges that changed since the last sync
+    std::vector<Buffer::DirtyRange> m_dirty;
 
 };
 
@@ -109,8 +146,13 @@ public:
     /**
      * @brief tick the cycle buffer
      * @warning DO NOT USE! this happens automatically by a window before the rendering starts. 
+     * 
+     * The tick never waits for running writes. If a write is running, the buffer is skipped and must be ticked again. 
+     * 
+     * @return true : all backends hold the current data
+     * @return false : at least one backend still needs to be synced in a later tick
      */
-    void tick() noexcept;
+    bool tick() noexcept;
 
     /**
      * @brief Get the buffer that is currently ready for GPU consumption
@@ -147,12 +189,40 @@ public:
     /**
      * @brief write the data for a section of the buffer
      * 
+     * Multiple threads may write to disjoint sections at the same time without blocking each other. 
+     * Writers only wait while the buffer is ticked, set or re-sized. 
+     * 
      * @param data the data to write to the section
      * @param size the size of the data to write
      * @param offset the byte offset from the start of the buffer
      */
     void write(void* data, uint64_t size, uint64_t offset) noexcept;
 
+    /**
+     * @brief get direct write access to a section of the buffer
+     * 
+     * The section may be written in place until `unmap` is called, which publishes all changes at once. 
+     * Like `write`, multiple threads may map disjoint sections at the same time. 
+     * 
+     * @warning each successful map must be followed by exactly one unmap of the same section. Sets and re-sizes of the buffer wait until then 
+     *          and ticks skip the buffer, so keep the mapping short. 
+     * @warning the thread that holds the mapping must not set or re-size the buffer before the unmap, 
+     *          as it would wait for its own mapping forever. Debug builds abort in that case. 
+     * 
+     * @param offset the byte offset from the start of the buffer
+     * @param size the size of the section in bytes
+     * @return void* a pointer to the start of the section or nullptr if the section is out of bounds (then no unmap is needed)
+     */
+    void* map(uint64_t offset, uint64_t size) noexcept;
+
+    /**
+     * @brief finish writing to a mapped section and publish the changes
+     * 
+     * @param offset the byte offset of the mapped section
+     * @param size the size of the mapped section in bytes
+     */
+    void unmap(uint64_t offset, uint64_t size) noexcept;
+
     /**
      * @brief change the size of the buffer
      * @warning this may truncate data
@@ -175,13 +245,105 @@ public:
      */
     inline uint32_t getVersion() const noexcept {return m_version.load(std::memory_order_acquire);}
 
+    /**
+     * @brief Get how often a writer had to wait because a cycle buffer was ticked, set or re-sized
+     * 
+     * @return uint64_t the amount of waiting writes over all cycle buffers
+     */
+    inline static uint64_t getWriteWaitCount() noexcept {return s_writeWaits.load(std::memory_order_relaxed);}
+
+    /**
+     * @brief Get how often a tick was skipped or a set or re-size had to wait for running writes to finish
+     * 
+     * @return uint64_t the amount of waiting exclusive accesses over all cycle buffers
+     */
+    inline static uint64_t getExclusiveWaitCount() noexcept {return s_exclusiveWaits.load(std::memory_order_relaxed);}
+
     //store all the cycle buffers
     inline static std::vector<API::CycleBuffer*> s_buffers;
     //store a mutex to make the buffer vector thread safe
     inline static std::shared_mutex s_mtx;
+    //store all cycle buffers that were written or still have backends that are not synced
+    inline static std::vector<API::CycleBuffer*> s_dirty;
+    //store the list of dirty cycle buffers that is currently ticked (kept to re-use the memory)
+    inline static std::vector<API::CycleBuffer*> s_ticking;
+    //store a mutex to make the dirty list thread safe
+    inline static std::mutex s_dirtyMtx;
 
 protected:
 
+    /**
+     * @brief the bit of the write gate that is set while a thread has exclusive access
+     */
+    inline static constexpr uint32_t GATE_EXCLUSIVE = 0x80000000u;
+
+    /**
+     * @brief define how often a thread that waits for the write gate spins before it starts to yield
+     */
+    inline static constexpr uint32_t GATE_SPIN_LIMIT = 64;
+
+    /**
+     * @brief define how many written ranges are stored between two ticks before all backends fall back to a full copy
+     */
+    inline static constexpr uint32_t MAX_PENDING_RANGES = 32;
+
+    /**
+     * @brief add this buffer to the list of dirty cycle buffers if it is not in it yet
+     */
+    void queueTick() noexcept;
+
+    /**
+     * @brief register a writer, waits while another thread has exclusive access
+     */
+    void beginWrite() noexcept;
+
+    /**
+     * @brief unregister a writer
+     */
+    inline void endWrite() noexcept {m_gate.fetch_sub(1, std::memory_order_release);}
+
+    /**
+     * @brief get exclusive access to the buffer, waits until all running writes are finished
+     */
+    void lockExclusive() noexcept;
+
+    /**
+     * @brief get exclusive access to the buffer if no write is running, never waits
+     * 
+     * @return true : the caller has exclusive access
+     * @return false : a write is running or another thread has exclusive access
+     */
+    bool tryLockExclusive() noexcept;
+
+    /**
+     * @brief wait a short moment for the write gate to change
+     * 
+     * @param spins the amount of times the calling thread already waited, increased by this function
+     */
+    static void gateBackoff(uint32_t& spins) noexcept;
+
+    /**
+     * @brief release the exclusive access to the buffer
+     */
+    inline void unlockExclusive() noexcept {m_gate.fetch_and(~GATE_EXCLUSIVE, std::memory_order_release);}
+
+    /**
+     * @brief pass the ranges written since the last tick to all backends
+     * @warning the caller must have exclusive access to the cycle buffer
+     */
+    void flushPendingRanges() noexcept;
+
+    /**
+     * @brief change the size of the CPU side data
+     * @warning the caller must have exclusive access to the cycle buffer
+     * 
+     * @param size the new size of the buffer
+     */
+    void resizeData(uint64_t size) noexcept;
+
+    //the instance ticks the dirty buffers
+    friend class Instance;
+
     //store the size of the buffer
     uint64_t m_size = 0;
     //store the raw data
@@ -192,13 +354,25 @@ protected:
     const uint8_t cm_usedBuffers = 0;
     //store the current GPU buffer
     std::atomic_uint8_t m_gpuBuff{0};
+    //store if the buffer is in the list of dirty cycle buffers
+    std::atomic_bool m_tickQueued{false};
     //store the current version
     std::atomic_uint32_t m_version{0};
-    //make the buffer thread safe
-    std::mutex m_mtx;
+    //store the write gate
+    //the lower bits count the running writes, the highest bit is set while a thread has exclusive access
+    std::atomic_uint32_t m_gate{0};
+    //store the amount of ranges written since the last tick
+    std::atomic_uint32_t m_pendingCount{0};
+    //store the ranges written since the last tick (holds MAX_PENDING_RANGES elements)
+    Buffer::DirtyRange* m_pending = nullptr;
     //store all the cycle buffer backends
     CycleBufferBackend* m_backends[GLGE_BUFFER_MAX_RING_BUFFER_COUNT] = { nullptr };
 
+    //count how often writers had to wait for exclusive access to end
+    inline static std::atomic_uint64_t s_writeWaits{0};
+    //count how often exclusive access had to wait for writers or a tick was skipped because of them
+    inline static std::atomic_uint64_t s_exclusiveWaits{0};
+
 };
 
 }
@@ -18,17 +18,60 @@
 #include "API_Buffer.h"
 //add cycle buffers
 #include "API_CycleBuffer.h"
+//add render meshes to compact the geometry
+#include "API_RenderMesh.h"
+//add render pipelines to not compact while recording
+#include "API_RenderPipeline.h"
 
 void GLGE::Graphic::Backend::API::Instance::tick() noexcept
 {
+    //let the backend close the last frame
+    onBeginTick();
+
+    //compact the geometry
+    //this runs first so the new mesh data is uploaded in the same tick as the moved geometry
+    {
+        //render meshes must not move while a render pipeline records, so skip the compaction this tick if one does
+        std::unique_lock<std::shared_mutex> recordLock(RenderPipeline::s_recordMtx, std::try_to_lock);
+        if (recordLock.owns_lock()) {
+            //free the regions the GPU no longer reads
+            m_abs_vertexBuffer->releaseRetired();
+            m_abs_indexBuffer->releaseRetired();
+        }
+        if (recordLock.owns_lock() && m_compactionBudget) {
+            //move some render meshes closer to the start of the arenas
+            RenderMesh::compactAll(m_compactionBudget);
+            //release the free memory at the end of the arenas
+            //arenas with a single buffer only shrink if at least half of the arena is unused, as shrinking re-creates the buffer
+            m_abs_vertexBuffer->trim(m_abs_vertexBuffer->isPaged() ? 0 : (m_abs_vertexBuffer->getSize() / 2));
+            m_abs_indexBuffer->trim(m_abs_indexBuffer->isPaged() ? 0 : (m_abs_indexBuffer->getSize() / 2));
+        }
+    }
+
     //update the cycle buffers
     {
         //thread safety
         std::shared_lock lock(API::CycleBuffer::s_mtx);
 
-        //tick all the buffers
-        for (auto& buff : API::CycleBuffer::s_buffers)
-        {buff->tick();}
+        if (m_tickDirtyCycleBuffersOnly) {
+            //take the current dirty list, so writes during the tick queue the buffers for the next tick
+            {
+                std::unique_lock dirtyLock(API::CycleBuffer::s_dirtyMtx);
+                API::CycleBuffer::s_ticking.swap(API::CycleBuffer::s_dirty);
+            }
+            //tick only the dirty buffers
+            for (API::CycleBuffer* buff : API::CycleBuffer::s_ticking) {
+                //writes from now on must queue the buffer again
+                buff->m_tickQueued.store(false, std::memory_order_release);
+                //buffers with backends that still wait for the GPU or with running writes stay in the list
+                if (!buff->tick()) {buff->queueTick();}
+            }
+            API::CycleBuffer::s_ticking.clear();
+        } else {
+            //tick all the buffers
+            for (auto& buff : API::CycleBuffer::s_buffers)
+            {buff->tick();}
+        }
     }
     
     //textures
@@ -50,5 +93,7 @@ void GLGE::Graphic::Backend::API::Instance::tick() noexcept
             buff->m_queued.store(false, std::memory_order_release);
         }
         API::Buffer::m_queue.clear();
+        //publish the amount of uploaded bytes of this tick
+        API::Buffer::m_lastUploadedBytes.store(API::Buffer::m_uploadedBytes.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
     }
 };
\ No newline at end of file
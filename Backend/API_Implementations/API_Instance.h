@@ -18,6 +18,8 @@
 
 //add memory arenas
 #include "API_MemoryArena.h"
+//add the record pool to configure parallel recording
+#include "API_RecordPool.h"
 //add frontend structure buffers
 #include "../../../Frontend/StructuredBuffer.h"
 
@@ -62,13 +64,20 @@ public:
     /**
      * @brief Destroy the Instance
      */
-    virtual ~Instance() {}
+    virtual ~Instance() {API::RecordPool::setThreadCount(0);}
 
     /**
      * @brief tick the whole graphic stuff
      */
     void tick() noexcept;
 
+    /**
+     * @brief called at the start of a tick, before any buffer is synced
+     * 
+     * Everything that was submitted since the last tick belongs to the frame that ends here. 
+     */
+    virtual void onBeginTick() noexcept {}
+
     /**
      * @brief update the own instance
      */
@@ -88,6 +97,114 @@ public:
      */
     inline API::MemoryArena* getIndexBuffer() noexcept {return m_abs_indexBuffer;}
 
+    /**
+     * @brief make sure the vertex and index memory arenas can hold a specific amount of data
+     * 
+     * Use this before loading a lot of meshes so the arenas only resize once. 
+     * 
+     * @param vertexBytes the minimal size of the vertex memory arena in bytes
+     * @param indexBytes the minimal size of the index memory arena in bytes
+     */
+    inline void reserveGeometry(uint64_t vertexBytes, uint64_t indexBytes) noexcept
+    {m_abs_vertexBuffer->reserve(vertexBytes); m_abs_indexBuffer->reserve(indexBytes);}
+
+    /**
+     * @brief store the vertex and index data in pages of a fixed size
+     * 
+     * Growing a paged arena adds a new page instead of copying all existing geometry to a larger buffer. 
+     * This must be called before any render mesh is created. 
+     * 
+     * @param pageSize the size of a single page in bytes
+     * @return true : both arenas are now paged
+     * @return false : at least one arena already holds data or the page size is 0, so no arena was changed
+     */
+    inline bool setGeometryPageSize(uint64_t pageSize) noexcept
+    {
+        //check both arenas first, so a failure never leaves only one of them paged
+        if ((pageSize == 0) || m_abs_vertexBuffer->getSize() || m_abs_indexBuffer->getSize()) {return false;}
+        return m_abs_vertexBuffer->setPageSize(pageSize) && m_abs_indexBuffer->setPageSize(pageSize);
+    }
+
+    /**
+     * @brief Set if the vertex and index data is written directly to the GPU without keeping a CPU side copy
+     * 
+     * This halves the memory the geometry needs, but the geometry data can't be read back on the CPU. 
+     * Geometry writes are staged and copied to the GPU behind all frames that were already submitted. 
+     * 
+     * @param writeThrough true : don't keep a CPU side copy | false : keep a CPU side copy
+     * @return true : both arenas use the requested mode
+     * @return false : at least one arena holds data, so the CPU side copy can't be restored and no arena was changed
+     */
+    inline bool setGeometryWriteThrough(bool writeThrough) noexcept
+    {
+        //only stopping write-through can fail, so check both arenas first to not change only one of them
+        if (!writeThrough && ((m_abs_vertexBuffer->isWriteThrough() && m_abs_vertexBuffer->getSize()) || 
+                              (m_abs_indexBuffer->isWriteThrough() && m_abs_indexBuffer->getSize()))) {return false;}
+        return m_abs_vertexBuffer->setWriteThrough(writeThrough) && m_abs_indexBuffer->setWriteThrough(writeThrough);
+    }
+
+    /**
+     * @brief Set the amount of geometry data that may be moved per tick to compact the vertex and index arenas
+     * 
+     * Compaction moves the data of render meshes into free regions closer to the start of the arenas, 
+     * so the unused memory at the end of the arenas can be released. Compaction is disabled by default and 
+     * skips every tick in which a render pipeline records. 
+     * 
+     * @param budget the maximal amount of bytes to move per tick (0 disables compaction)
+     */
+    inline void setCompactionBudget(uint64_t budget) noexcept {m_compactionBudget = budget;}
+
+    /**
+     * @brief Get the amount of geometry data that may be moved per tick to compact the vertex and index arenas
+     * 
+     * @return uint64_t the maximal amount of bytes to move per tick
+     */
+    inline uint64_t getCompactionBudget() const noexcept {return m_compactionBudget;}
+
+    /**
+     * @brief Set if only cycle buffers that were written to are ticked
+     * 
+     * By default every cycle buffer is ticked each frame. If this is enabled, only buffers that were written to 
+     * and buffers with ring buffers that are not synced yet are ticked, so idle buffers cost nothing. 
+     * 
+     * @param onlyDirty true : only tick dirty cycle buffers | false : tick all cycle buffers
+     */
+    inline void setTickDirtyCycleBuffersOnly(bool onlyDirty) noexcept {m_tickDirtyCycleBuffersOnly = onlyDirty;}
+
+    /**
+     * @brief Get if only cycle buffers that were written to are ticked
+     * 
+     * @return true : only dirty cycle buffers are ticked | false : all cycle buffers are ticked
+     */
+    inline bool getTickDirtyCycleBuffersOnly() const noexcept {return m_tickDirtyCycleBuffersOnly;}
+
+    /**
+     * @brief Set if small buffers are stored as slices of a few large pooled GPU buffers
+     * 
+     * Pooling cuts down the amount of GPU buffers and buffer bindings for scenes with a lot of small buffers like materials. 
+     * This only affects buffers that are created or re-sized afterwards. 
+     * 
+     * @param enabled true : small buffers are pooled | false : each buffer uses its own GPU buffers
+     */
+    virtual void setBufferPooling(bool enabled) noexcept {(void)enabled;}
+
+    /**
+     * @brief Set the amount of threads that help recording render pipeline stages
+     * 
+     * The stages of a render pipeline that need to be recorded again are split across the threads 
+     * and stitched together in the order of the stages afterwards. 
+     * 
+     * @param count the amount of helping threads (0 records all stages on the recording thread of the pipeline)
+     */
+    inline void setRecordThreadCount(uint8_t count) noexcept {API::RecordPool::setThreadCount(count);}
+
+    /**
+     * @brief Get the amount of threads that help recording render pipeline stages
+     * 
+     * @return uint8_t the amount of helping threads
+     */
+    inline uint8_t getRecordThreadCount() const noexcept {return API::RecordPool::getThreadCount();}
+
     /**
      * @brief Get the Mesh Buffer of the instance
      * 
@@ -103,6 +220,10 @@ protected:
     API::MemoryArena* m_abs_indexBuffer = nullptr;
     //store a structured buffer for the mesh data
     StructuredBuffer<MeshGPUInfo> m_meshBuffer;
+    //store the amount of bytes the geometry compaction may move per tick
+    uint64_t m_compactionBudget = 0;
+    //store if only dirty cycle buffers are ticked
+    bool m_tickDirtyCycleBuffersOnly = false;
 
 };
 
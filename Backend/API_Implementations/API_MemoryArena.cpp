@@ -11,20 +11,53 @@
 
 //include the GPU memory arena
 #include "API_MemoryArena.h"
+//add the maximum amount of frames in flight to delay page trims
+#include "../../Frontend/RenderAPI/RenderPipeline.h"
 
 //add memcpy
 #include <cstring>
+//add bit operations for the TLSF class lookup
+#include <bit>
+//add binary search to find the page of a region
+#include <algorithm>
+
+GLGE::Graphic::Backend::API::MemoryArena::MemoryArena(uint64_t size, bool allowResize, Buffer* buffer, Strategy strategy) noexcept
+ : m_size(size), m_allowResize(allowResize), m_strategy(strategy), m_buff(buffer)
+{
+    //the buffer of the arena is always the first page
+    m_pages.push_back({buffer, 0});
+
+    //mark all TLSF free lists as empty
+    for (uint32_t fl = 0; fl < TLSF_FL_COUNT; ++fl) {
+        for (uint32_t sl = 0; sl < TLSF_SL_COUNT; ++sl) 
+        {m_tlsfHeads[fl][sl] = TLSF_NONE;}
+    }
+
+    //the whole arena starts as a single free region
+    if (m_strategy == TLSF) {
+        tlsfAddRegion(0, size);
+    } else {
+        m_free.push_back({0, size});
+    }
+}
 
 GLGE::Graphic::Backend::API::MemoryArena::~MemoryArena()
 {
     //clear all vectors
     m_free.clear();
+    m_tlsfBlocks.clear();
+    m_tlsfUnusedBlocks.clear();
+    m_tlsfUsed.clear();
     //say that no data is stored
     m_size = 0;
 }
 
 GLGE::Graphic::Backend::API::MemoryArena::GraphicPointer GLGE::Graphic::Backend::API::MemoryArena::allocate(uint64_t size) noexcept
 {
+    //the TLSF allocator handles the allocation on its own
+    //it works on arena-wide indices, so convert the result to the page it lives in
+    if (m_strategy == TLSF) {return toPagePointer(tlsfAllocate(size));}
+
     //iterate over all free regions
     for (uint64_t i = 0; i < m_free.size(); ++i)
     {
@@ -57,164 +90,533 @@ GLGE::Graphic::Backend::API::MemoryArena::GraphicPointer GLGE::Graphic::Backend:
         return {0,0};
     }
 
-    //store if the last element should be extended
-    bool m_extend = m_free.size() > 0;
-    //check if extend is currently possible
-    if (m_extend)
-    {
-        //check if it is also the correct one
-        m_extend = ((m_free[m_free.size()-1].startIdx + m_free[m_free.size()-1].size) == m_size);
-    }
-    //not enough free space is found. Append or grow the end of the array to fit the data
-    if (m_extend)
-    {
-        //the last element reaches to the end of the array. Just increase the size. 
+    //store how much free space is at the end of the arena
+    uint64_t tailFree = 0;
+    if (m_free.size() && ((m_free.back().startIdx + m_free.back().size) == m_size))
+    {tailFree = m_free.back().size;}
 
-        //calculate the new size
-        uint64_t nSize = m_size + (size - m_free[m_free.size()-1].size);
+    //not enough free space is found. Grow the arena so the last free region can hold the data
+    uint64_t oldSize = m_size;
+    resize(getGrownSize(m_size + (size - tailFree)));
+    addFreeRegion(oldSize, m_size - oldSize);
 
-        //resize the memory arena
-        resize(nSize);
+    //the last free region now reaches to the end of the arena and is large enough
+    uint64_t idx = m_free.back().startIdx;
+    m_free.back().startIdx += size;
+    m_free.back().size -= size;
+    //if the region is full, remove it
+    if (m_free.back().size == 0)
+    {m_free.pop_back();}
 
-        //store the index of the last element
-        uint64_t idx = m_free[m_free.size()-1].startIdx;
-        //erase the last element. It is now full. 
-        m_free.erase(m_free.end());
+    //return the new pointer
+    return {idx, size};
+}
 
-        //return the last element
-        return {idx, size};
+bool GLGE::Graphic::Backend::API::MemoryArena::release(GraphicPointer& ptr) noexcept
+{
+    //the TLSF allocator handles the release on its own
+    if (m_strategy == TLSF) {
+        //it works on arena-wide indices, so convert the pointer back from its page
+        if (ptr.page >= m_pages.size()) {return false;}
+        //recorded frames may still draw from the page, so it is not trimmed right away
+        m_pages[ptr.page].releaseFrame = getCurrentFrame();
+        return tlsfRelease({getArenaIndex(ptr), ptr.size});
     }
-    else
-    {
-        //the last element is allready filled. Add a new element to the end. 
 
-        //store the index as the current size
-        uint64_t idx = m_size;
-        //change the size by the missing size
-        resize(m_size + size);
-        //return a new pointer to the end of the array
-        return {idx, size};
+    //null pointers and regions outside of the arena can't be freed
+    if ((ptr.size == 0) || ((ptr.startIdx + ptr.size) > m_size)) {return false;}
+
+    //the free regions are sorted by their start index
+    //find the first free region that starts behind the pointer
+    auto next = std::upper_bound(m_free.begin(), m_free.end(), ptr.startIdx, 
+                                 [](uint64_t idx, const GraphicPointer& region) {return idx < region.startIdx;});
+    //safety check if the requested area is not free
+    //only the regions directly before and after the pointer can overlap with it
+    if ((next != m_free.end()) && ((ptr.startIdx + ptr.size) > next->startIdx)) {return false;}
+    if ((next != m_free.begin()) && (((next-1)->startIdx + (next-1)->size) > ptr.startIdx)) {return false;}
+
+    //check if the freed region aligns with the free regions around it
+    bool mergePrev = (next != m_free.begin()) && (((next-1)->startIdx + (next-1)->size) == ptr.startIdx);
+    bool mergeNext = (next != m_free.end()) && ((ptr.startIdx + ptr.size) == next->startIdx);
+
+    if (mergePrev && mergeNext) {
+        //the freed region closes the gap between two free regions, so merge all three
+        (next-1)->size += ptr.size + next->size;
+        m_free.erase(next);
+    } else if (mergePrev) {
+        //just increase the size of the region before this one
+        (next-1)->size += ptr.size;
+    } else if (mergeNext) {
+        //move the start of the next region to the start of the freed region
+        next->startIdx = ptr.startIdx;
+        next->size += ptr.size;
+    } else {
+        //no alignment found. Insert the freed section. 
+        m_free.insert(next, ptr);
     }
+
+    //return the successful freeing
+    return true;
 }
 
-bool GLGE::Graphic::Backend::API::MemoryArena::release(GraphicPointer& ptr) noexcept
+GLGE::Graphic::Backend::API::MemoryArena::GraphicPointer GLGE::Graphic::Backend::API::MemoryArena::relocate(const GraphicPointer& ptr) noexcept
 {
-    //store the index the free section will be inserted at
-    uint64_t insert = 0;
-    //safety check if the requested area is not free
-    //check all free segments for overlap with the pointer
-    for (uint64_t i = 0; i < m_free.size(); ++i)
-    {
-        //get a reference to the current pointer
-        const GraphicPointer& pointer = m_free[i];
-        //check for overlap
-        if (((pointer.startIdx < ptr.startIdx) && ((pointer.startIdx + pointer.size) <= ptr.startIdx)) || 
-            ((pointer.startIdx > ptr.startIdx) && (pointer.startIdx >= (ptr.startIdx + ptr.size))))
-        {
-            //check if a next element exists
-            if (i != m_free.size()-1)
-            {
-                //check if the element is in between this and the next element
-                //it is allready ensured to not collide, so only check the pointer indices
-                //collision with the next element is not checked, so make sure to add the length
-                //of the region to the pointer to prevent overlap
-                if ((pointer.startIdx < ptr.startIdx) && ((ptr.startIdx + ptr.size) <= m_free[i+1].startIdx))
-                {
-                    //store this as the insertion index
-                    insert = i;
-                }
-            }
-            continue;
-        }
+    //null pointers can't be moved
+    if (ptr.size == 0) {return ptr;}
+
+    //the region may only move into existing free space, so prevent the arena from growing
+    bool allowResize = m_allowResize;
+    m_allowResize = false;
+    GraphicPointer moved = allocate(ptr.size);
+    m_allowResize = allowResize;
+    //if no free region fits, the region stays
+    if (moved.size == 0) {return ptr;}
 
-        //return the intersection
-        return false;
+    //only keep the new region if it is closer to the start of the arena
+    //draws that were recorded but not played yet bind the page of the region, so the region never changes its page
+    if ((moved.page != ptr.page) || (getArenaIndex(moved) >= getArenaIndex(ptr))) {
+        release(moved);
+        return ptr;
     }
 
-    //add the free section
+    //copy the data over
+    m_pages[moved.page].buffer->copy(m_pages[ptr.page].buffer, ptr.startIdx, moved.startIdx, ptr.size);
+    //frames in flight may still read the old region, so it is only released once the GPU finished them
+    m_retired.push_back({ptr, getCurrentFrame()});
+    return moved;
+}
 
-    //first, check if a free section aligns with another free section
-    //check if a section at this one exists (if free sections exist)
-    if (m_free.size() != 0)
-    {
-        //check the section before this one
-        //first, fetch the section
-        GraphicPointer& pointer = m_free[insert];
-        //now, check if the end section perfectly aligns with the start section
-        if ((pointer.startIdx + pointer.size) == ptr.startIdx)
-        {
-            //just increase the size of the region before this one
-            pointer.size += ptr.size;
+uint64_t GLGE::Graphic::Backend::API::MemoryArena::releaseRetired() noexcept
+{
+    //store how many bytes were released
+    uint64_t released = 0;
+    //the regions are retired in order, so stop at the first one that may still be in use
+    uint64_t completed = getCompletedFrame();
+    size_t count = 0;
+    for (; count < m_retired.size(); ++count) {
+        if (m_retired[count].frame > completed) {break;}
+        released += m_retired[count].ptr.size;
+        release(m_retired[count].ptr);
+    }
+    m_retired.erase(m_retired.begin(), m_retired.begin() + count);
+    return released;
+}
 
-            //check if the section should merge with the next one
-            //first, check if a next one exists
-            if (insert != m_free.size()-1)
-            {
-                //fetch the next section
-                GraphicPointer& next = m_free[insert+1];
-                //check if the end aligns with the next section
-                if ((pointer.startIdx + pointer.size) == next.startIdx)
-                {
-                    //merge the sections by growing the first one by the size of the second one
-                    pointer.size += next.size;
-                    //erase the later section
-                    m_free.erase(m_free.begin() + insert + 1);
-                }
-            }
+uint64_t GLGE::Graphic::Backend::API::MemoryArena::trim(uint64_t minSize) noexcept
+{
+    //store the size to compute the amount of released bytes
+    uint64_t oldSize = m_size;
 
-            //successfully freed it
-            return true;
+    //the first fit strategy only needs to check the last free region
+    if (m_strategy != TLSF) {
+        //check if the last free region reaches to the end of the arena
+        if (!m_free.size() || ((m_free.back().startIdx + m_free.back().size) != m_size)) {return 0;}
+        if ((m_free.back().size == 0) || (m_free.back().size < minSize)) {return 0;}
+        //cut the free region from the arena
+        uint64_t newSize = m_free.back().startIdx;
+        m_free.pop_back();
+        resize(newSize);
+        //also release the CPU side storage
+        m_buff->shrinkToFit();
+        return oldSize - m_size;
+    }
+
+    //paged arenas drop all completely free pages at the end, but keep the first page
+    if (m_pageSize) {
+        //count how many bytes are in free pages at the end
+        uint64_t freeBytes = 0;
+        uint32_t freePages = 0;
+        uint64_t completed = getCompletedFrame();
+        for (uint64_t i = m_pages.size() - 1; i > 0; --i) {
+            //stop at the first page that is not completely free
+            //pages with only a single free block contain no allocation
+            const TLSFBlock& first = m_tlsfBlocks[m_pages[i].firstBlock];
+            if (!first.isFree || (first.nextPhys != TLSF_NONE)) {break;}
+            //a frame recorded before the last release may still be played, so the page is kept until all of them finished
+            if ((m_pages[i].releaseFrame + GLGE_MAX_FRAMES_IN_FLIGHT) > completed) {break;}
+            freeBytes += first.size;
+            ++freePages;
         }
+        if ((freeBytes == 0) || (freeBytes < minSize)) {return 0;}
 
-        //now, check if a section is after this one exists
-        if (insert != m_free.size()-1)
-        {
-            //first, fetch the section
-            GraphicPointer& next = m_free[insert+1];
-            //check if the end of the to free pointer aligns with the start of the next one
-            if ((ptr.startIdx + ptr.size) == next.startIdx)
-            {
-                //decrease the start index and increase the size by the size of the free'd pointer
-                next.startIdx -= ptr.size;
-                next.size += ptr.size;
-
-                //check if a section should merge with the one before this
-                //first, check if there is a section before this one
-                if (insert != 0)
-                {
-                    //check if the sections aligns
-                    if ((pointer.startIdx + pointer.size) == next.startIdx)
-                    {
-                        //grow the previous section to include this one
-                        pointer.size += next.size;
-                        //erase this section
-                        m_free.erase(m_free.begin() + insert + 1);
-                    }
-                }
-
-                //free'd the pointer successfully
-                return true;
-            }
+        //drop the pages
+        for (uint32_t i = 0; i < freePages; ++i) {
+            //the only block of the page is no longer needed
+            uint32_t block = m_pages.back().firstBlock;
+            tlsfRemoveFree(block);
+            m_tlsfUnusedBlocks.push_back(block);
+            //the arena now ends where the page started
+            m_size = m_pages.back().startIdx;
+            destroyPage(m_pages.back().buffer);
+            m_pages.pop_back();
         }
+        //find the new last block by walking along the last remaining page
+        m_tlsfLast = m_pages.back().firstBlock;
+        while ((m_tlsfLast != TLSF_NONE) && (m_tlsfBlocks[m_tlsfLast].nextPhys != TLSF_NONE)) 
+        {m_tlsfLast = m_tlsfBlocks[m_tlsfLast].nextPhys;}
+        return oldSize - m_size;
     }
 
-    //no alignment found. Insert the freed section. 
-    m_free.insert(m_free.begin() + insert, ptr);
-
-    //return the successful freeing
-    return true;
+    //else, just cut the last block if it is free
+    uint32_t last = m_tlsfLast;
+    if ((last == TLSF_NONE) || !m_tlsfBlocks[last].isFree || (m_tlsfBlocks[last].size < minSize)) {return 0;}
+    //unlink the block
+    tlsfRemoveFree(last);
+    m_tlsfLast = m_tlsfBlocks[last].prevPhys;
+    if (m_tlsfLast != TLSF_NONE) {m_tlsfBlocks[m_tlsfLast].nextPhys = TLSF_NONE;}
+    m_tlsfUnusedBlocks.push_back(last);
+    //shrink the buffer
+    resize(m_tlsfBlocks[last].startIdx);
+    //also release the CPU side storage
+    m_buff->shrinkToFit();
+    return oldSize - m_size;
 }
 
 void GLGE::Graphic::Backend::API::MemoryArena::update(const GraphicPointer& ptr, void* data) noexcept
 {
-    //just write the data to the GPU buffer
-    m_buff->write(data, ptr.size, ptr.startIdx);
+    //just write the data to the GPU buffer of the page
+    m_pages[ptr.page].buffer->write(data, ptr.size, ptr.startIdx);
 }
 
 void GLGE::Graphic::Backend::API::MemoryArena::resize(uint64_t size) noexcept
 {
+    //paged arenas never resize a page, they only add new pages
+    if (m_pageSize) {
+        reserve(size);
+        return;
+    }
+
     //just resize the underlying buffer
     m_buff->resize(size);
     //and store the new size
     m_size = size;
+}
+
+void GLGE::Graphic::Backend::API::MemoryArena::reserve(uint64_t size) noexcept
+{
+    //only grow, never shrink
+    if (size <= m_size) {return;}
+
+    //paged arenas add full pages until they are large enough
+    if (m_pageSize) {
+        while (m_size < size) 
+        {if (!addPage(m_pageSize)) {break;}}
+        return;
+    }
+
+    //resize once and make the new space available
+    uint64_t oldSize = m_size;
+    resize(size);
+    addFreeRegion(oldSize, m_size - oldSize);
+}
+
+bool GLGE::Graphic::Backend::API::MemoryArena::setPageSize(uint64_t pageSize) noexcept
+{
+    //paging can only be enabled for empty arenas
+    if ((pageSize == 0) || (m_size != 0)) {return false;}
+
+    //paged arenas always use TLSF, as it never merges regions of different pages
+    m_strategy = TLSF;
+    m_free.clear();
+    m_pageSize = pageSize;
+    return true;
+}
+
+bool GLGE::Graphic::Backend::API::MemoryArena::setWriteThrough(bool writeThrough) noexcept
+{
+    //the CPU side copy can't be restored if data is stored
+    if (!writeThrough && m_writeThrough && m_size) {return false;}
+    //apply the mode to all pages
+    for (const Page& page : m_pages) {page.buffer->setWriteThrough(writeThrough);}
+    m_writeThrough = writeThrough;
+    return true;
+}
+
+bool GLGE::Graphic::Backend::API::MemoryArena::addPage(uint64_t size) noexcept
+{
+    //if the first page has no storage yet, use it instead of adding a new page
+    if ((m_pages.size() == 1) && (m_size == 0)) {
+        m_buff->resize(size);
+    } else {
+        //create the buffer for the new page
+        Buffer* buffer = createPage(size);
+        if (!buffer) {return false;}
+        //new pages use the same mode as the rest of the arena
+        buffer->setWriteThrough(m_writeThrough);
+        //the new page starts at the end of the arena
+        m_pages.push_back({buffer, m_size});
+    }
+
+    //the new page must never merge with the previous page
+    tlsfAddRegion(m_size, size, false);
+    m_pages.back().firstBlock = m_tlsfLast;
+    m_size += size;
+    return true;
+}
+
+GLGE::Graphic::Backend::API::MemoryArena::GraphicPointer GLGE::Graphic::Backend::API::MemoryArena::toPagePointer(const GraphicPointer& ptr) const noexcept
+{
+    //null pointers and arenas with a single page don't need a conversion
+    if ((ptr.size == 0) || (m_pages.size() == 1)) {return ptr;}
+
+    //find the last page that starts at or before the region
+    auto pos = std::upper_bound(m_pages.begin(), m_pages.end(), ptr.startIdx, 
+                                [](uint64_t idx, const Page& page) {return idx < page.startIdx;});
+    uint32_t page = (uint32_t)((pos - m_pages.begin()) - 1);
+    //make the start index relative to the page
+    return {ptr.startIdx - m_pages[page].startIdx, ptr.size, page};
+}
+
+uint64_t GLGE::Graphic::Backend::API::MemoryArena::getGrownSize(uint64_t required) const noexcept
+{
+    //switch over the growth policy
+    switch (m_growth)
+    {
+    case GROW_DOUBLE:
+        //at least double the size
+        return (required > (m_size * 2)) ? required : (m_size * 2);
+        break;
+    case GROW_CHUNK:
+        //round up to the next full chunk
+        if (m_growthChunk == 0) {return required;}
+        return ((required + m_growthChunk - 1) / m_growthChunk) * m_growthChunk;
+        break;
+    
+    default:
+        //grow by exactly the required amount
+        return required;
+        break;
+    }
+}
+
+void GLGE::Graphic::Backend::API::MemoryArena::addFreeRegion(uint64_t startIdx, uint64_t size) noexcept
+{
+    //empty regions are skipped
+    if (size == 0) {return;}
+
+    //the TLSF allocator handles the region on its own
+    if (m_strategy == TLSF) {
+        tlsfAddRegion(startIdx, size);
+        return;
+    }
+
+    //if the last free region ends at the new region, just grow it
+    if (m_free.size() && ((m_free.back().startIdx + m_free.back().size) == startIdx)) {
+        m_free.back().size += size;
+    } else {
+        m_free.push_back({startIdx, size});
+    }
+}
+
+void GLGE::Graphic::Backend::API::MemoryArena::tlsfMapping(uint64_t size, uint32_t& fl, uint32_t& sl) noexcept
+{
+    //small sizes are mapped linearly into the first first level class
+    if (size < TLSF_SL_COUNT) {
+        fl = 0;
+        sl = (uint32_t)size;
+        return;
+    }
+    //get the index of the most significant bit
+    uint32_t msb = std::bit_width(size) - 1;
+    //the bits directly below the most significant bit select the second level class
+    sl = (uint32_t)(size >> (msb - TLSF_SL_LOG2)) ^ TLSF_SL_COUNT;
+    //the most significant bit selects the first level class
+    fl = msb - TLSF_SL_LOG2 + 1;
+}
+
+GLGE::Graphic::Backend::API::MemoryArena::GraphicPointer GLGE::Graphic::Backend::API::MemoryArena::tlsfAllocate(uint64_t size) noexcept
+{
+    //a size of 0 is the null pointer
+    if (size == 0) {return {0,0};}
+
+    //round the size up to the next class boundary so every block in the found class is large enough
+    uint64_t search = size;
+    if (search >= TLSF_SL_COUNT) {
+        uint64_t round = (1ull << ((std::bit_width(search) - 1) - TLSF_SL_LOG2)) - 1;
+        //if the rounding would overflow, no block can be large enough
+        search = (search + round < search) ? UINT64_MAX : search + round;
+    }
+    uint32_t fl = 0, sl = 0;
+    tlsfMapping(search, fl, sl);
+
+    //find the first non-empty class that is at least as large as the requested class
+    uint32_t slMap = m_tlsfSLBitmap[fl] & (~0u << sl);
+    if (!slMap) {
+        //no class in the same first level class, search the larger first level classes
+        uint64_t flMap = (fl + 1 < TLSF_FL_COUNT) ? (m_tlsfFLBitmap & (~0ull << (fl + 1))) : 0;
+        if (flMap) {
+            fl = std::countr_zero(flMap);
+            slMap = m_tlsfSLBitmap[fl];
+        }
+    }
+    //if a class was found, use its first block
+    if (slMap) {
+        sl = std::countr_zero(slMap);
+        return tlsfUseBlock(m_tlsfHeads[fl][sl], size);
+    }
+
+    //the rounding may skip a free last block that still fits, so check it directly
+    uint64_t tailFree = ((m_tlsfLast != TLSF_NONE) && m_tlsfBlocks[m_tlsfLast].isFree) ? m_tlsfBlocks[m_tlsfLast].size : 0;
+    if (tailFree >= size) {return tlsfUseBlock(m_tlsfLast, size);}
+
+    //before resizing, check if resizing is allowed
+    if (!m_allowResize) {return {0,0};}
+
+    //paged arenas add a new page that can hold the region instead of resizing
+    if (m_pageSize) {
+        //regions larger than a page get a page that is a multiple of the page size
+        if (!addPage(((size + m_pageSize - 1) / m_pageSize) * m_pageSize)) {return {0,0};}
+        return tlsfUseBlock(m_tlsfLast, size);
+    }
+
+    //grow the arena so the last block can hold the requested size
+    uint64_t oldSize = m_size;
+    resize(getGrownSize(m_size + (size - tailFree)));
+    tlsfAddRegion(oldSize, m_size - oldSize);
+    //the last block is now free and large enough
+    return tlsfUseBlock(m_tlsfLast, size);
+}
+
+bool GLGE::Graphic::Backend::API::MemoryArena::tlsfRelease(const GraphicPointer& ptr) noexcept
+{
+    //find the block that belongs to the pointer
+    auto pos = m_tlsfUsed.find(ptr.startIdx);
+    if (pos == m_tlsfUsed.end()) {return false;}
+    uint32_t block = pos->second;
+    //the size must match, else the pointer is not the allocated region
+    if (m_tlsfBlocks[block].size != ptr.size) {return false;}
+    m_tlsfUsed.erase(pos);
+
+    //merge with the previous block if it is free
+    uint32_t prev = m_tlsfBlocks[block].prevPhys;
+    if ((prev != TLSF_NONE) && m_tlsfBlocks[prev].isFree) {
+        tlsfRemoveFree(prev);
+        //grow the previous block to include this one
+        m_tlsfBlocks[prev].size += m_tlsfBlocks[block].size;
+        m_tlsfBlocks[prev].nextPhys = m_tlsfBlocks[block].nextPhys;
+        if (m_tlsfBlocks[block].nextPhys != TLSF_NONE) {m_tlsfBlocks[m_tlsfBlocks[block].nextPhys].prevPhys = prev;}
+        if (m_tlsfLast == block) {m_tlsfLast = prev;}
+        //the block record is no longer needed
+        m_tlsfUnusedBlocks.push_back(block);
+        block = prev;
+    }
+
+    //merge with the next block if it is free
+    uint32_t next = m_tlsfBlocks[block].nextPhys;
+    if ((next != TLSF_NONE) && m_tlsfBlocks[next].isFree) {
+        tlsfRemoveFree(next);
+        //grow this block to include the next one
+        m_tlsfBlocks[block].size += m_tlsfBlocks[next].size;
+        m_tlsfBlocks[block].nextPhys = m_tlsfBlocks[next].nextPhys;
+        if (m_tlsfBlocks[next].nextPhys != TLSF_NONE) {m_tlsfBlocks[m_tlsfBlocks[next].nextPhys].prevPhys = block;}
+        if (m_tlsfLast == next) {m_tlsfLast = block;}
+        //the block record is no longer needed
+        m_tlsfUnusedBlocks.push_back(next);
+    }
+
+    //store the merged block as free
+    tlsfInsertFree(block);
+    return true;
+}
+
+void GLGE::Graphic::Backend::API::MemoryArena::tlsfAddRegion(uint64_t startIdx, uint64_t size, bool merge) noexcept
+{
+    //empty regions are skipped
+    if (size == 0) {return;}
+
+    //if the last block is free and ends at the new region, just grow it
+    if (merge && (m_tlsfLast != TLSF_NONE) && m_tlsfBlocks[m_tlsfLast].isFree &&
+        ((m_tlsfBlocks[m_tlsfLast].startIdx + m_tlsfBlocks[m_tlsfLast].size) == startIdx)) {
+        tlsfRemoveFree(m_tlsfLast);
+        m_tlsfBlocks[m_tlsfLast].size += size;
+        tlsfInsertFree(m_tlsfLast);
+        return;
+    }
+
+    //else, create a new block behind the last block
+    //a separate region is not linked to the last block, so the two can never merge
+    uint32_t block = tlsfNewBlock();
+    m_tlsfBlocks[block].startIdx = startIdx;
+    m_tlsfBlocks[block].size = size;
+    m_tlsfBlocks[block].prevPhys = merge ? m_tlsfLast : TLSF_NONE;
+    m_tlsfBlocks[block].nextPhys = TLSF_NONE;
+    if (merge && (m_tlsfLast != TLSF_NONE)) {m_tlsfBlocks[m_tlsfLast].nextPhys = block;}
+    m_tlsfLast = block;
+    tlsfInsertFree(block);
+}
+
+GLGE::Graphic::Backend::API::MemoryArena::GraphicPointer GLGE::Graphic::Backend::API::MemoryArena::tlsfUseBlock(uint32_t block, uint64_t size) noexcept
+{
+    //the block is no longer free
+    tlsfRemoveFree(block);
+
+    //if the block is larger than requested, split the rest into a new free block
+    if (m_tlsfBlocks[block].size > size) {
+        //creating the new block may move the block storage, so don't keep references
+        uint32_t rest = tlsfNewBlock();
+        m_tlsfBlocks[rest].startIdx = m_tlsfBlocks[block].startIdx + size;
+        m_tlsfBlocks[rest].size = m_tlsfBlocks[block].size - size;
+        m_tlsfBlocks[rest].prevPhys = block;
+        m_tlsfBlocks[rest].nextPhys = m_tlsfBlocks[block].nextPhys;
+        if (m_tlsfBlocks[block].nextPhys != TLSF_NONE) {m_tlsfBlocks[m_tlsfBlocks[block].nextPhys].prevPhys = rest;}
+        m_tlsfBlocks[block].nextPhys = rest;
+        m_tlsfBlocks[block].size = size;
+        if (m_tlsfLast == block) {m_tlsfLast = rest;}
+        tlsfInsertFree(rest);
+    }
+
+    //register the used block so it can be found on release
+    m_tlsfUsed.insert_or_assign(m_tlsfBlocks[block].startIdx, block);
+    return {m_tlsfBlocks[block].startIdx, size};
+}
+
+void GLGE::Graphic::Backend::API::MemoryArena::tlsfInsertFree(uint32_t block) noexcept
+{
+    //get the class of the block
+    uint32_t fl = 0, sl = 0;
+    tlsfMapping(m_tlsfBlocks[block].size, fl, sl);
+    //push the block to the front of the free list
+    TLSFBlock& b = m_tlsfBlocks[block];
+    b.isFree = true;
+    b.prevFree = TLSF_NONE;
+    b.nextFree = m_tlsfHeads[fl][sl];
+    if (b.nextFree != TLSF_NONE) {m_tlsfBlocks[b.nextFree].prevFree = block;}
+    m_tlsfHeads[fl][sl] = block;
+    //mark the class as non-empty
+    m_tlsfFLBitmap |= 1ull << fl;
+    m_tlsfSLBitmap[fl] |= 1u << sl;
+}
+
+void GLGE::Graphic::Backend::API::MemoryArena::tlsfRemoveFree(uint32_t block) noexcept
+{
+    //get the class of the block
+    uint32_t fl = 0, sl = 0;
+    tlsfMapping(m_tlsfBlocks[block].size, fl, sl);
+    //unlink the block from the free list
+    TLSFBlock& b = m_tlsfBlocks[block];
+    if (b.prevFree != TLSF_NONE) {m_tlsfBlocks[b.prevFree].nextFree = b.nextFree;}
+    else {m_tlsfHeads[fl][sl] = b.nextFree;}
+    if (b.nextFree != TLSF_NONE) {m_tlsfBlocks[b.nextFree].prevFree = b.prevFree;}
+    b.prevFree = TLSF_NONE;
+    b.nextFree = TLSF_NONE;
+    b.isFree = false;
+    //if the class is now empty, clear the bits
+    if (m_tlsfHeads[fl][sl] == TLSF_NONE) {
+        m_tlsfSLBitmap[fl] &= ~(1u << sl);
+        if (!m_tlsfSLBitmap[fl]) {m_tlsfFLBitmap &= ~(1ull << fl);}
+    }
+}
+
+uint32_t GLGE::Graphic::Backend::API::MemoryArena::tlsfNewBlock() noexcept
+{
+    //re-use an old record if possible
+    if (m_tlsfUnusedBlocks.size()) {
+        uint32_t block = m_tlsfUnusedBlocks.back();
+        m_tlsfUnusedBlocks.pop_back();
+        m_tlsfBlocks[block] = TLSFBlock{};
+        return block;
+    }
+    //else, create a new record
+    m_tlsfBlocks.emplace_back();
+    return (uint32_t)(m_tlsfBlocks.size() - 1);
 }
\ No newline at end of file
@@ -22,6 +22,8 @@
 #include <iostream>
 //add simple vectors
 #include <vector>
+//add a hash map to find allocated blocks by their start index
+#include <unordered_map>
 //add a mutex for thread safety
 #include <mutex>
 //add buffer
@@ -53,6 +55,12 @@ public:
          * @brief the size of the region
          */
         uint64_t size = 0;
+        /**
+         * @brief the page the region lives in (always 0 for arenas that are not paged)
+         * 
+         * The start index is relative to the start of the page. 
+         */
+        uint32_t page = 0;
 
         /**
          * @brief check if two graphic pointer point to the same memory region
@@ -62,7 +70,7 @@ public:
          * @return true : both pointers point to the same region
          * @return false : they point to different regions
          */
-        inline bool operator==(const GraphicPointer& ptr) const noexcept {return (startIdx == ptr.startIdx) && (size == ptr.size);}
+        inline bool operator==(const GraphicPointer& ptr) const noexcept {return (startIdx == ptr.startIdx) && (size == ptr.size) && (page == ptr.page);}
 
         /**
          * @brief print a graphic pointer into the default output
@@ -71,7 +79,33 @@ public:
          * @param ptr the pointer to print
          * @return std::ostream& the filled output stream
          */
-        inline friend std::ostream& operator<<(std::ostream& os, const GraphicPointer& ptr) noexcept {return os << "GraphicPointer{index: " << ptr.startIdx << ", size: " << ptr.size << "}";}
+        inline friend std::ostream& operator<<(std::ostream& os, const GraphicPointer& ptr) noexcept {return os << "GraphicPointer{index: " << ptr.startIdx << ", size: " << ptr.size << ", page: " << ptr.page << "}";}
+    };
+
+    /**
+     * @brief define the strategy the memory arena uses to manage free regions
+     */
+    enum Strategy : uint8_t
+    {
+        //search a sorted list of free regions and use the first region that fits
+        //allocation and release are linear in the amount of free regions
+        FIRST_FIT = 0,
+        //use a two-level segregated fit (TLSF) allocator
+        //allocation and release run in constant time and free regions are merged immediately
+        TLSF
+    };
+
+    /**
+     * @brief define how the memory arena grows if no free region is large enough
+     */
+    enum GrowthPolicy : uint8_t
+    {
+        //grow by exactly the missing amount of bytes
+        GROW_EXACT = 0,
+        //grow to at least double the current size
+        GROW_DOUBLE,
+        //grow by a multiple of a fixed chunk size
+        GROW_CHUNK
     };
 
     /**
@@ -85,10 +119,9 @@ public:
      * @param size the size of the arena in bytes
      * @param allowResize specify if dynamic resizing is allowed
      * @param buffer a pointer to the buffer to store the data to
+     * @param strategy the strategy that is used to manage the free regions of the arena
      */
-    MemoryArena(uint64_t size, bool allowResize, Buffer* buffer) noexcept
-     : m_size(size), m_allowResize(allowResize), m_free({{0,size}}), m_buff(buffer)
-    {}
+    MemoryArena(uint64_t size, bool allowResize, Buffer* buffer, Strategy strategy = FIRST_FIT) noexcept;
 
     /**
      * @brief Destroy the Graphic Memory Arena
@@ -113,6 +146,37 @@ public:
      */
     bool release(GraphicPointer& ptr) noexcept;
 
+    /**
+     * @brief move a region closer to the start of the memory arena
+     * 
+     * The region is only moved into free space that already exists in its own page, so the arena never grows and 
+     * draws that were recorded with the page of the region stay valid. 
+     * If a closer free region is found, the data is copied. The old region is released by `releaseRetired` 
+     * once the GPU finished all frames that could still read it. 
+     * 
+     * @param ptr the region to move
+     * @return GraphicPointer the new region or `ptr` if no free region closer to the start fits
+     */
+    GraphicPointer relocate(const GraphicPointer& ptr) noexcept;
+
+    /**
+     * @brief release the regions `relocate` moved data away from once the GPU finished all frames that used them
+     * 
+     * @return uint64_t the amount of bytes that were released
+     */
+    uint64_t releaseRetired() noexcept;
+
+    /**
+     * @brief release unused memory at the end of the memory arena
+     * 
+     * Paged arenas only drop pages at the end that are completely free. The first page is never dropped. 
+     * A page is only dropped once all frames that could have been recorded before its last release finished. 
+     * 
+     * @param minSize the minimal amount of free bytes at the end of the arena before anything is released
+     * @return uint64_t the amount of bytes that were released
+     */
+    uint64_t trim(uint64_t minSize = 0) noexcept;
+
     /**
      * @brief write new data into a section of VRam
      * 
@@ -124,10 +188,107 @@ public:
     /**
      * @brief change the size of the memory arena
      * 
+     * A paged arena never resizes its pages, so it only grows by adding pages until it has at least the requested size. 
+     * 
      * @param size the new size of the memory arena in bytes
      */
     void resize(uint64_t size) noexcept;
 
+    /**
+     * @brief make sure the memory arena is at least a specific size
+     * 
+     * This resizes the arena at most once and makes the new space available for allocation. 
+     * Use this before loading a lot of data to prevent repeated resizing. 
+     * 
+     * @param size the minimal size of the memory arena in bytes
+     */
+    void reserve(uint64_t size) noexcept;
+
+    /**
+     * @brief switch the memory arena to paged mode
+     * 
+     * A paged arena stores its data in a list of fixed-size buffers. If it runs out of memory, a new page is added 
+     * instead of resizing the existing buffer, so live data is never copied. Allocations never cross a page and 
+     * regions larger than a page get their own page that is rounded up to a multiple of the page size. 
+     * Paged arenas always use the TLSF strategy and ignore the growth policy. 
+     * 
+     * @warning this only works as long as the arena is empty
+     * 
+     * @param pageSize the size of a single page in bytes
+     * @return true : the arena is now paged
+     * @return false : the arena is not empty or the page size is 0
+     */
+    bool setPageSize(uint64_t pageSize) noexcept;
+
+    /**
+     * @brief Get the size of a single page
+     * 
+     * @return uint64_t the size of a page in bytes or 0 if the arena is not paged
+     */
+    inline uint64_t getPageSize() const noexcept {return m_pageSize;}
+
+    /**
+     * @brief check if the memory arena is paged
+     * 
+     * @return true : the arena stores its data in multiple pages
+     * @return false : the arena uses a single buffer
+     */
+    inline bool isPaged() const noexcept {return m_pageSize != 0;}
+
+    /**
+     * @brief Get the amount of pages of the memory arena
+     * 
+     * @return uint32_t the amount of pages (always 1 for arenas that are not paged)
+     */
+    inline uint32_t getPageCount() const noexcept {return (uint32_t)m_pages.size();}
+
+    /**
+     * @brief Set if the arena writes directly to the GPU without keeping a CPU side copy of the data
+     * 
+     * This applies to all existing and all future pages. Updates are staged and copied to the GPU with the next 
+     * buffer update, so they never race frames that were already submitted. 
+     * 
+     * @warning the data of write-through arenas can't be accessed using `get` or `getRaw`
+     * 
+     * @param writeThrough true : don't keep a CPU side copy | false : keep a CPU side copy
+     * @return true : the mode was changed
+     * @return false : the arena is not empty, so the CPU side copy can't be restored
+     */
+    bool setWriteThrough(bool writeThrough) noexcept;
+
+    /**
+     * @brief check if the arena writes directly to the GPU without keeping a CPU side copy of the data
+     * 
+     * @return true : the arena is write-through | false : the arena keeps a CPU side copy
+     */
+    inline bool isWriteThrough() const noexcept {return m_writeThrough;}
+
+    /**
+     * @brief Get the Buffer that stores a specific page
+     * 
+     * @warning the page index is not sanity-checked
+     * 
+     * @param page the index of the page
+     * @return `API::Buffer*` a pointer to the buffer of the page
+     */
+    inline API::Buffer* getPageBuffer(uint32_t page) const noexcept {return m_pages[page].buffer;}
+
+    /**
+     * @brief Set the Growth Policy of the memory arena
+     * 
+     * @param policy the policy to use when the arena needs to grow
+     * @param chunkSize the size of a chunk in bytes (only used for `GROW_CHUNK`)
+     */
+    inline void setGrowthPolicy(GrowthPolicy policy, uint64_t chunkSize = 0) noexcept
+    {m_growth = policy; m_growthChunk = chunkSize;}
+
+    /**
+     * @brief Get the Growth Policy of the memory arena
+     * 
+     * @return GrowthPolicy the policy used when the arena needs to grow
+     */
+    inline GrowthPolicy getGrowthPolicy() const noexcept {return m_growth;}
+
     /**
      * @brief Get the Size of the memory arena
      * 
@@ -158,10 +319,19 @@ public:
      */
     inline bool isResizable()const noexcept {return m_allowResize;}
 
+    /**
+     * @brief Get the Strategy the memory arena uses to manage free regions
+     * 
+     * @return Strategy the allocation strategy of the memory arena
+     */
+    inline Strategy getStrategy() const noexcept {return m_strategy;}
+
     /**
      * @brief Get the whole raw data of the memory arena
      * 
-     * @return void* the whole raw data
+     * @warning for paged arenas this is only the data of the first page
+     * 
+     * @return void* the whole raw data (nullptr for write-through arenas)
      */
     inline void* getRaw() const noexcept {return m_buff->getRaw();}
 
@@ -171,19 +341,225 @@ public:
      * @warning the region is not sanity-checked
      * 
      * @param ptr a pointer to the region to access
-     * @return void* the data of the region
+     * @return void* the data of the region (nullptr for write-through arenas)
      */
-    inline void* get(const GraphicPointer& ptr) {return (void*)(((uint8_t*)m_buff->getRaw()) + ptr.startIdx);}
+    inline void* get(const GraphicPointer& ptr) {
+        uint8_t* raw = (uint8_t*)m_pages[ptr.page].buffer->getRaw();
+        return raw ? (void*)(raw + ptr.startIdx) : nullptr;
+    }
 
     /**
      * @brief Get the Buffer of the memory arena
      * 
-     * @return `API::Buffer*` a pointer to the buffer of the memory arena
+     * @return `API::Buffer*` a pointer to the buffer of the memory arena (the first page for paged arenas)
      */
     inline API::Buffer* getBuffer() const noexcept {return m_buff;}
 
 protected:
 
+    /**
+     * @brief store a single page of the memory arena
+     */
+    struct Page
+    {
+        //store the buffer that holds the data of the page
+        Buffer* buffer = nullptr;
+        //store the arena-wide index the page starts at
+        uint64_t startIdx = 0;
+        //store the first TLSF block of the page (only used for paged arenas)
+        uint32_t firstBlock = TLSF_NONE;
+        //store the last frame a region of the page was released in (only used for paged arenas)
+        uint64_t releaseFrame = 0;
+    };
+
+    /**
+     * @brief create the buffer for a new page
+     * 
+     * The buffer must already have the requested size. It is owned by the implementation. 
+     * 
+     * @param size the size of the page in bytes
+     * @return Buffer* a pointer to the new buffer or `nullptr` if paging is not supported
+     */
+    virtual Buffer* createPage(uint64_t) noexcept {return nullptr;}
+
+    /**
+     * @brief destroy the buffer of a page that was created by `createPage`
+     * 
+     * @param buffer the buffer of the page to destroy
+     */
+    virtual void destroyPage(Buffer*) noexcept {}
+
+    /**
+     * @brief Get the index of the frame that is currently recorded
+     * 
+     * @return uint64_t the index of the current frame (always 0 if the API does not track frames)
+     */
+    virtual uint64_t getCurrentFrame() const noexcept {return 0;}
+
+    /**
+     * @brief Get the index of the last frame the GPU finished
+     * 
+     * @return uint64_t the index of the last completed frame (all frames are completed if the API does not track frames)
+     */
+    virtual uint64_t getCompletedFrame() const noexcept {return UINT64_MAX;}
+
+    /**
+     * @brief store a region that was moved away from, but may still be read by the GPU
+     */
+    struct RetiredRegion
+    {
+        //store the region that is released later
+        GraphicPointer ptr;
+        //store the last frame that may use the region
+        uint64_t frame = 0;
+    };
+
+    /**
+     * @brief get the arena-wide start index of a region
+     * 
+     * @param ptr the region to get the start index of
+     * @return uint64_t the start index of the region relative to the start of the arena
+     */
+    inline uint64_t getArenaIndex(const GraphicPointer& ptr) const noexcept {return m_pages[ptr.page].startIdx + ptr.startIdx;}
+
+    /**
+     * @brief add a new page to the end of a paged arena and make it available for allocation
+     * 
+     * @param size the size of the new page in bytes
+     * @return true : the page was added
+     * @return false : failed to create the page
+     */
+    bool addPage(uint64_t size) noexcept;
+
+    /**
+     * @brief convert a pointer with an arena-wide start index into a pointer relative to its page
+     * 
+     * @param ptr the pointer with the arena-wide start index
+     * @return GraphicPointer the pointer relative to the page it lives in
+     */
+    GraphicPointer toPagePointer(const GraphicPointer& ptr) const noexcept;
+
+    /**
+     * @brief compute the size the arena grows to
+     * 
+     * @param required the minimal size the arena must have after growing
+     * @return uint64_t the new size of the arena according to the growth policy
+     */
+    uint64_t getGrownSize(uint64_t required) const noexcept;
+
+    /**
+     * @brief make a new region at the end of the arena available for allocation
+     * 
+     * @param startIdx the start index of the new region
+     * @param size the size of the new region
+     */
+    void addFreeRegion(uint64_t startIdx, uint64_t size) noexcept;
+
+    /**
+     * @brief store the log2 of the amount of second level classes per first level class of the TLSF allocator
+     */
+    static constexpr uint8_t TLSF_SL_LOG2 = 5;
+    /**
+     * @brief store the amount of second level classes per first level class
+     */
+    static constexpr uint8_t TLSF_SL_COUNT = 1 << TLSF_SL_LOG2;
+    /**
+     * @brief store the amount of first level classes (enough to map every 64 bit size)
+     */
+    static constexpr uint8_t TLSF_FL_COUNT = 64 - TLSF_SL_LOG2 + 1;
+    /**
+     * @brief a value that marks an invalid block index
+     */
+    static constexpr uint32_t TLSF_NONE = UINT32_MAX;
+
+    /**
+     * @brief store a single physical block of the TLSF allocator
+     */
+    struct TLSFBlock
+    {
+        //store the start index of the block
+        uint64_t startIdx = 0;
+        //store the size of the block in bytes
+        uint64_t size = 0;
+        //store the physically previous block
+        uint32_t prevPhys = TLSF_NONE;
+        //store the physically next block
+        uint32_t nextPhys = TLSF_NONE;
+        //store the previous block in the same free list
+        uint32_t prevFree = TLSF_NONE;
+        //store the next block in the same free list
+        uint32_t nextFree = TLSF_NONE;
+        //store if the block is free
+        bool isFree = false;
+    };
+
+    /**
+     * @brief map a size to the first and second level class it belongs to
+     * 
+     * @param size the size to map
+     * @param fl the first level index to write to
+     * @param sl the second level index to write to
+     */
+    static void tlsfMapping(uint64_t size, uint32_t& fl, uint32_t& sl) noexcept;
+
+    /**
+     * @brief allocate a region using the TLSF allocator
+     * 
+     * @param size the size of the region to allocate
+     * @return GraphicPointer the allocated region or a null pointer if no free block fits
+     */
+    GraphicPointer tlsfAllocate(uint64_t size) noexcept;
+
+    /**
+     * @brief release a region using the TLSF allocator
+     * 
+     * @param ptr the region to release
+     * @return true : the region was released
+     * @return false : the region is not an allocated block
+     */
+    bool tlsfRelease(const GraphicPointer& ptr) noexcept;
+
+    /**
+     * @brief add a new region to the end of the TLSF allocator
+     * 
+     * The region is merged with the last block if that block is free. 
+     * 
+     * @param startIdx the start index of the new region
+     * @param size the size of the new region
+     * @param merge false to keep the region physically separate from all other blocks (used for pages)
+     */
+    void tlsfAddRegion(uint64_t startIdx, uint64_t size, bool merge = true) noexcept;
+
+    /**
+     * @brief remove a free block from the allocator, split it to the requested size and mark it as used
+     * 
+     * @param block the index of the free block to use
+     * @param size the size to cut from the start of the block
+     * @return GraphicPointer the pointer to the used region
+     */
+    GraphicPointer tlsfUseBlock(uint32_t block, uint64_t size) noexcept;
+
+    /**
+     * @brief insert a block into the free list of its size class
+     * 
+     * @param block the index of the block to insert
+     */
+    void tlsfInsertFree(uint32_t block) noexcept;
+
+    /**
+     * @brief remove a block from the free list of its size class
+     * 
+     * @param block the index of the block to remove
+     */
+    void tlsfRemoveFree(uint32_t block) noexcept;
+
+    /**
+     * @brief get a new block record
+     * 
+     * @return uint32_t the index of the new block record
+     */
+    uint32_t tlsfNewBlock() noexcept;
+
     /**
      * @brief store the complete size of the memory arena
      */
@@ -193,14 +569,71 @@ protected:
      */
     bool m_allowResize = true;
     /**
-     * @brief store a vector of free regions
+     * @brief store how the arena grows
+     */
+    GrowthPolicy m_growth = GROW_EXACT;
+    /**
+     * @brief store the chunk size for the chunk growth policy
+     */
+    uint64_t m_growthChunk = 0;
+    /**
+     * @brief store the strategy used to manage the free regions
+     */
+    Strategy m_strategy = FIRST_FIT;
+    /**
+     * @brief store a vector of free regions (first fit only)
      */
     std::vector<GraphicPointer> m_free;
 
+    /**
+     * @brief store all block records of the TLSF allocator
+     */
+    std::vector<TLSFBlock> m_tlsfBlocks;
+    /**
+     * @brief store the indices of unused block records so they can be recycled
+     */
+    std::vector<uint32_t> m_tlsfUnusedBlocks;
+    /**
+     * @brief map the start index of all allocated regions to their block records
+     */
+    std::unordered_map<uint64_t, uint32_t> m_tlsfUsed;
+    /**
+     * @brief store the physically last block
+     */
+    uint32_t m_tlsfLast = TLSF_NONE;
+    /**
+     * @brief store a bit for every first level class that has a free block
+     */
+    uint64_t m_tlsfFLBitmap = 0;
+    /**
+     * @brief store a bit for every second level class that has a free block
+     */
+    uint32_t m_tlsfSLBitmap[TLSF_FL_COUNT] = { 0 };
+    /**
+     * @brief store the first free block of every size class
+     */
+    uint32_t m_tlsfHeads[TLSF_FL_COUNT][TLSF_SL_COUNT];
+
     /**
      * @brief store a buffer that is used for the data storage
      */
     Buffer* m_buff = nullptr;
+    /**
+     * @brief store the size of a single page (0 if the arena is not paged)
+     */
+    uint64_t m_pageSize = 0;
+    /**
+     * @brief store if the arena keeps no CPU side copy of the data
+     */
+    bool m_writeThrough = false;
+    /**
+     * @brief store all pages of the arena (the first page is always the buffer of the arena)
+     */
+    std::vector<Page> m_pages;
+    /**
+     * @brief store the regions that are released once the GPU finished all frames that used them
+     */
+    std::vector<RetiredRegion> m_retired;
 };
 
 }
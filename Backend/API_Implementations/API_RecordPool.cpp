@@ -0,0 +1,120 @@
+/**
+ * @file API_RecordPool.cpp
+ * @author DM8AT
+ * @brief implement the pool of recording threads
+ * @version 0.1
+ * @date 2025-11-16
+ * 
+ * @copyright Copyright (c) 2025
+ * 
+ */
+
+//add the record pool
+#include "API_RecordPool.h"
+
+//use the API namespace locally
+using namespace GLGE::Graphic::Backend::API;
+
+void RecordPool::setThreadCount(uint8_t count) noexcept
+{
+    //nothing to do if the amount does not change
+    if (count == s_threads.size()) {return;}
+
+    //stop all running threads
+    {
+        std::lock_guard<std::mutex> lock(s_mtx);
+        s_stop = true;
+    }
+    s_cond.notify_all();
+    for (std::thread& thread : s_threads) {thread.join();}
+    s_threads.clear();
+
+    //start the new threads
+    s_stop = false;
+    s_threads.reserve(count);
+    for (uint8_t i = 0; i < count; ++i) {s_threads.emplace_back(&RecordPool::workerLoop);}
+}
+
+void RecordPool::run(uint64_t count, Job job, void* userData) noexcept
+{
+    //only a single batch can run at once, so other callers do their jobs on their own
+    std::unique_lock<std::mutex> runLock(s_runMtx, std::try_to_lock);
+    if (!runLock.owns_lock() || s_threads.empty() || (count < 2)) {
+        for (uint64_t i = 0; i < count; ++i) {(*job)(userData, i);}
+        return;
+    }
+
+    //publish the batch
+    {
+        std::lock_guard<std::mutex> lock(s_mtx);
+        s_job = job;
+        s_userData = userData;
+        s_count = count;
+        s_next.store(0, std::memory_order_relaxed);
+        s_done.store(0, std::memory_order_relaxed);
+        ++s_batch;
+    }
+    s_cond.notify_all();
+
+    //the calling thread helps, too
+    help(job, userData, count);
+
+    //wait for the jobs the pool threads are still running and for all threads to leave the batch
+    std::unique_lock<std::mutex> lock(s_mtx);
+    s_cond.wait(lock, [count]{ return (s_done.load(std::memory_order_acquire) == count) && (s_helpers == 0);});
+    //the batch is over, so late threads don't find any jobs
+    s_count = 0;
+}
+
+void RecordPool::help(Job job, void* userData, uint64_t count) noexcept
+{
+    //take jobs until all are handed out
+    uint64_t idx = s_next.fetch_add(1, std::memory_order_relaxed);
+    while (idx < count) {
+        (*job)(userData, idx);
+        //the last job wakes up the waiting caller
+        if ((s_done.fetch_add(1, std::memory_order_acq_rel) + 1) == count) {
+            std::lock_guard<std::mutex> lock(s_mtx);
+            s_cond.notify_all();
+        }
+        idx = s_next.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void RecordPool::workerLoop() noexcept
+{
+    //store the last batch the thread helped with
+    uint64_t batch = 0;
+    {
+        std::lock_guard<std::mutex> lock(s_mtx);
+        batch = s_batch;
+    }
+    while (true) {
+        //store the batch the thread helps with
+        Job job = nullptr;
+        void* userData = nullptr;
+        uint64_t count = 0;
+        {
+            //wait for a new batch or the stop signal
+            std::unique_lock<std::mutex> lock(s_mtx);
+            s_cond.wait(lock, [batch]{ return s_stop || (s_batch != batch);});
+            if (s_stop) {return;}
+            batch = s_batch;
+            //take the batch, the caller does not publish a new one before the thread left it
+            job = s_job;
+            userData = s_userData;
+            count = s_count;
+            if (count) {++s_helpers;}
+        }
+        //the batch may already be over
+        if (!count) {continue;}
+        //run jobs of the batch
+        help(job, userData, count);
+        //leave the batch
+        {
+            std::lock_guard<std::mutex> lock(s_mtx);
+            --s_helpers;
+        }
+        s_cond.notify_all();
+    }
+}
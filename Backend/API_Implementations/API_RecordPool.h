@@ -0,0 +1,125 @@
+/**
+ * @file API_RecordPool.h
+ * @author DM8AT
+ * @brief define a pool of threads that record render pipeline stages in parallel
+ * @version 0.1
+ * @date 2025-11-16
+ * 
+ * @copyright Copyright (c) 2025
+ * 
+ */
+
+//header guard
+#ifndef _GLGE_GRAPHIC_BACKEND_API_IMPL_API_RECORD_POOL_
+#define _GLGE_GRAPHIC_BACKEND_API_IMPL_API_RECORD_POOL_
+
+//add types
+#include "../../../../GLGE_Core/Types.h"
+
+//only available for C++
+#if __cplusplus
+
+//add threads for the workers
+#include <thread>
+//add vectors to store the workers
+#include <vector>
+//add a mutex and a conditional variable for syncing
+#include <mutex>
+#include <condition_variable>
+//add atomics to hand out the jobs
+#include <atomic>
+
+//use the GLGE::Graphic::Backend::API namespace
+namespace GLGE::Graphic::Backend::API
+{
+
+/**
+ * @brief a pool of threads that record render pipeline stages in parallel
+ * 
+ * The thread that runs a batch of jobs always helps, so without any pool threads all jobs run on the calling thread.
+ */
+class RecordPool
+{
+public:
+
+    /**
+     * @brief the function type of a single job
+     * 
+     * @param userData the user data passed to `run`
+     * @param idx the index of the job
+     */
+    using Job = void (*)(void* userData, uint64_t idx);
+
+    /**
+     * @brief Set the amount of threads in the pool
+     * @warning this must not be called while jobs are running
+     * 
+     * @param count the amount of threads that help the recording thread (0 means all jobs run on the recording thread)
+     */
+    static void setThreadCount(uint8_t count) noexcept;
+
+    /**
+     * @brief Get the amount of threads in the pool
+     * 
+     * @return uint8_t the amount of threads that help the recording thread
+     */
+    inline static uint8_t getThreadCount() noexcept {return (uint8_t)s_threads.size();}
+
+    /**
+     * @brief run a batch of jobs and wait for all of them to finish
+     * 
+     * If another batch is running already, all jobs run on the calling thread.
+     * 
+     * @param count the amount of jobs to run
+     * @param job the function to call for each job
+     * @param userData the user data to pass to each job
+     */
+    static void run(uint64_t count, Job job, void* userData) noexcept;
+
+protected:
+
+    /**
+     * @brief the loop of a single pool thread
+     */
+    static void workerLoop() noexcept;
+
+    /**
+     * @brief run jobs of the current batch until no jobs are left
+     * 
+     * @param job the function of the batch
+     * @param userData the user data of the batch
+     * @param count the amount of jobs of the batch
+     */
+    static void help(Job job, void* userData, uint64_t count) noexcept;
+
+    //store all threads of the pool
+    inline static std::vector<std::thread> s_threads;
+    //store a mutex that only allows a single batch at once
+    inline static std::mutex s_runMtx;
+    //store a mutex and a conditional variable to wake up the threads and wait for the batch
+    inline static std::mutex s_mtx;
+    inline static std::condition_variable s_cond;
+    //store the index of the current batch, the threads wake up if it changes (guarded by s_mtx)
+    inline static uint64_t s_batch = 0;
+    //store if the threads should stop (guarded by s_mtx)
+    inline static bool s_stop = false;
+    //store the function of the current batch (guarded by s_mtx)
+    inline static Job s_job = nullptr;
+    //store the user data of the current batch (guarded by s_mtx)
+    inline static void* s_userData = nullptr;
+    //store the amount of jobs of the current batch (guarded by s_mtx)
+    inline static uint64_t s_count = 0;
+    //store the amount of pool threads that took the current batch and did not leave it yet (guarded by s_mtx)
+    inline static uint32_t s_helpers = 0;
+    //store the index of the next job to hand out
+    inline static std::atomic_uint64_t s_next{0};
+    //store the amount of finished jobs
+    inline static std::atomic_uint64_t s_done{0};
+
+};
+
+}
+
+#endif
+
+#endif
@@ -26,6 +26,33 @@ GLGE::Graphic::Backend::API::RenderMesh::RenderMesh(::RenderMesh* rMesh)
     Backend::INSTANCE.getInstance()->getVertexBuffer()->update(m_vboPointer, m_rMesh->getMesh()->getVertices());
     Backend::INSTANCE.getInstance()->getIndexBuffer()->update(m_iboPointer, m_rMesh->getMesh()->getIndices());
 
+    //create and upload the GPU data
+    updateGPUData();
+
+    //register the render mesh so it can be compacted
+    std::unique_lock lock(s_meshMtx);
+    if (s_meshes.size() <= m_rMesh->getUID()) {s_meshes.resize(m_rMesh->getUID()+1, nullptr);}
+    s_meshes[m_rMesh->getUID()] = this;
+}
+
+GLGE::Graphic::Backend::API::RenderMesh::~RenderMesh()
+{
+    //remove the render mesh from the list of render meshes
+    {
+        std::unique_lock lock(s_meshMtx);
+        if ((m_rMesh->getUID() < s_meshes.size()) && (s_meshes[m_rMesh->getUID()] == this)) 
+        {s_meshes[m_rMesh->getUID()] = nullptr;}
+    }
+
+    //if the instance was deleted, the GPU memory is allready freed
+    if (!Backend::INSTANCE.getInstance()) {return;}
+    //free the pointer
+    Backend::INSTANCE.getInstance()->getVertexBuffer()->release(m_vboPointer);
+    Backend::INSTANCE.getInstance()->getIndexBuffer()->release(m_iboPointer);
+}
+
+void GLGE::Graphic::Backend::API::RenderMesh::updateGPUData() noexcept
+{
     //create the GPU data
     m_gpu.iboOffset = m_iboPointer.startIdx / sizeof(index_t);
     m_gpu.indexCount = m_iboPointer.size / sizeof(index_t);
@@ -40,11 +67,51 @@ GLGE::Graphic::Backend::API::RenderMesh::RenderMesh(::RenderMesh* rMesh)
     meshBuffer->set(m_rMesh->getUID(), m_gpu);
 }
 
-GLGE::Graphic::Backend::API::RenderMesh::~RenderMesh()
+uint64_t GLGE::Graphic::Backend::API::RenderMesh::compact() noexcept
 {
-    //if the instance was deleted, the GPU memory is allready freed
-    if (!Backend::INSTANCE.getInstance()) {return;}
-    //free the pointer
-    Backend::INSTANCE.getInstance()->getVertexBuffer()->release(m_vboPointer);
-    Backend::INSTANCE.getInstance()->getIndexBuffer()->release(m_iboPointer);
+    //store how many bytes were moved
+    uint64_t moved = 0;
+
+    //try to move the vertex data
+    MemoryArena::GraphicPointer vbo = Backend::INSTANCE.getInstance()->getVertexBuffer()->relocate(m_vboPointer);
+    if (!(vbo == m_vboPointer)) {
+        m_vboPointer = vbo;
+        moved += vbo.size;
+    }
+    //try to move the index data
+    MemoryArena::GraphicPointer ibo = Backend::INSTANCE.getInstance()->getIndexBuffer()->relocate(m_iboPointer);
+    if (!(ibo == m_iboPointer)) {
+        m_iboPointer = ibo;
+        moved += ibo.size;
+    }
+
+    //if something moved, the offsets on the GPU changed
+    if (moved) {updateGPUData();}
+    return moved;
+}
+
+uint64_t GLGE::Graphic::Backend::API::RenderMesh::compactAll(uint64_t budget) noexcept
+{
+    //thread safety
+    std::unique_lock lock(s_meshMtx);
+
+    //store how many bytes were moved
+    uint64_t moved = 0;
+    //visit a limited amount of render meshes so a call stays cheap, even if nothing can move
+    uint64_t visits = (s_meshes.size() < 256) ? s_meshes.size() : 256;
+    for (uint64_t i = 0; i < visits; ++i) {
+        //wrap the cursor around
+        if (s_compactCursor >= s_meshes.size()) {s_compactCursor = 0;}
+        RenderMesh* mesh = s_meshes[s_compactCursor];
+        //skip empty slots
+        if (!mesh) {++s_compactCursor; continue;}
+        //stop if moving the mesh could exceed the budget (a single mesh is always allowed to move)
+        if (moved && ((moved + mesh->m_vboPointer.size + mesh->m_iboPointer.size) > budget)) {break;}
+        //compact the mesh and continue with the next one
+        moved += mesh->compact();
+        ++s_compactCursor;
+        //stop if the budget is used up
+        if (moved >= budget) {break;}
+    }
+    return moved;
 }
\ No newline at end of file
@@ -20,6 +20,9 @@ class RenderMesh;
 
 //add instances
 #include "API_Instance.h"
+//add vectors and mutexes to keep track of all render meshes
+#include <vector>
+#include <mutex>
 
 //use the GLGE::Graphic::Backend::API namespace
 namespace GLGE::Graphic::Backend::API
@@ -74,8 +77,34 @@ public:
      */
     inline const MeshGPUInfo& getGPUData() const noexcept {return m_gpu;}
 
+    /**
+     * @brief move the vertex and index data of the render mesh closer to the start of the memory arenas
+     * 
+     * @warning this must be called from the thread that owns the graphic context
+     * 
+     * @return uint64_t the amount of bytes that were moved
+     */
+    uint64_t compact() noexcept;
+
+    /**
+     * @brief incrementally compact the vertex and index data of all render meshes
+     * 
+     * Every call continues where the last call stopped, so over multiple calls all render meshes are visited. 
+     * 
+     * @warning this must be called from the thread that owns the graphic context
+     * 
+     * @param budget the maximal amount of bytes to move
+     * @return uint64_t the amount of bytes that were moved
+     */
+    static uint64_t compactAll(uint64_t budget) noexcept;
+
 protected:
 
+    /**
+     * @brief compute the GPU data from the vertex and index pointers and upload it to the mesh buffer
+     */
+    void updateGPUData() noexcept;
+
     //store a pointer to the frontend render mesh
     ::RenderMesh* m_rMesh = nullptr;
     //store a graphic pointer to the vertex data in the memory arena
@@ -85,6 +114,13 @@ protected:
     //store the GPU data
     MeshGPUInfo m_gpu;
 
+    //store all existing render meshes by their unique identifier
+    inline static std::vector<RenderMesh*> s_meshes;
+    //store the unique identifier the next compaction continues at
+    inline static uint64_t s_compactCursor = 0;
+    //a mutex to protect the list of render meshes
+    inline static std::mutex s_meshMtx;
+
 };
 
 }
@@ -19,6 +19,11 @@
 //only available for C++
 #if __cplusplus
 
+//add atomics for the statistics
+#include <atomic>
+//add a shared mutex to block geometry compaction while recording
+#include <shared_mutex>
+
 //use the GLGE::Graphic::Backend::API namespace
 namespace GLGE::Graphic::Backend::API
 {
@@ -52,16 +57,59 @@ public:
 
     /**
      * @brief record the whole pipeline
+     * 
+     * @param frame the index of the frame slot to record to (less than GLGE_MAX_FRAMES_IN_FLIGHT). The slot is not played while it is recorded. 
+     */
+    virtual void record(uint8_t frame) noexcept = 0;
+
+    /**
+     * @brief copy the data that may change while the frame is recorded on the thread that requests the recording
+     * 
+     * This is called while the frame slot is neither recorded nor played. 
+     * 
+     * @param frame the index of the frame slot that is recorded next (less than GLGE_MAX_FRAMES_IN_FLIGHT)
      */
-    virtual void record() noexcept = 0;
+    virtual void snapshot(uint8_t frame) noexcept = 0;
 
     /**
      * @brief play back a recorded render pipeline
+     * 
+     * @param frame the index of the frame slot to play (less than GLGE_MAX_FRAMES_IN_FLIGHT)
+     */
+    virtual void play(uint8_t frame) noexcept = 0;
+
+    /**
+     * @brief Get the amount of commands the command optimizer removed from the last recorded frame
+     * 
+     * @return uint64_t the amount of removed commands
      */
-    virtual void play() noexcept = 0;
+    inline uint64_t getRemovedCommands() const noexcept {return m_removedCommands.load(std::memory_order_relaxed);}
+
+    /**
+     * @brief Get the amount of draw commands the command optimizer merged in the last recorded frame
+     * 
+     * @return uint64_t the amount of merged draw commands
+     */
+    inline uint64_t getMergedCommands() const noexcept {return m_mergedCommands.load(std::memory_order_relaxed);}
+
+    /**
+     * @brief a mutex that is locked shared while any render pipeline records
+     * 
+     * The instance only compacts the geometry if it can lock the mutex exclusively, so no recording sees a render mesh move. 
+     */
+    inline static std::shared_mutex s_recordMtx;
 
 protected:
 
+    /**
+     * @brief store the amount of commands the command optimizer removed from the last recorded frame
+     */
+    std::atomic_uint64_t m_removedCommands{0};
+    /**
+     * @brief store the amount of draw commands the command optimizer merged in the last recorded frame
+     */
+    std::atomic_uint64_t m_mergedCommands{0};
+
     /**
      * @brief store the frontend render pipeline this backend belongs to
      */
@@ -29,6 +29,12 @@
 #include "OGL_Material.h"
 //add cycle buffers
 #include "OGL_CycleBuffer.h"
+//add the pool for small buffers
+#include "OGL_BufferPool.h"
+//add the staging ring for uploads
+#include "OGL_StagingRing.h"
+//add the state cache
+#include "OGL_StateCache.h"
 //add framebuffers
 #include "OGL_Framebuffer.h"
 
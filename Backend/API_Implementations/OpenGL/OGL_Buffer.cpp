@@ -10,8 +10,12 @@
  */
 //add the buffer API
 #include "OGL_Buffer.h"
+//add the staging ring for uploads
+#include "OGL_StagingRing.h"
 //add memcpy
 #include <cstring>
+//add std::min
+#include <algorithm>
 //add OpenGL
 #include "glad/glad.h"
 
@@ -50,15 +54,28 @@ void GLGE::Graphic::Backend::OGL::Buffer::set(void* data, uint64_t dataSize) noe
     //thread safety
     std::unique_lock lock(m_dataMtx);
 
+    //write-through buffers only store the new data until the next update
+    if (m_writeThrough) {
+        //the whole buffer is replaced, so earlier writes don't matter anymore
+        m_pendingWrites.clear();
+        m_pendingBytes.clear();
+        addPendingWrite(data, dataSize, 0);
+        m_size = dataSize;
+        queueUpdate();
+        return;
+    }
+
+    //make sure the storage can hold the new data
+    reserveData(dataSize, false);
     //store the new size
     m_size = dataSize;
 
-    //allocate the new data and move over the new data
+    //move over the new data
     if (data && dataSize)
-    {
-        if (!m_data) { m_data = malloc(dataSize); }
-        memcpy(m_data, data, dataSize);
-    }
+    {memcpy(m_data, data, dataSize);}
+    //the whole buffer changed
+    m_dirty.clear();
+    markDirty(0, dataSize);
     //queue a data write
     queueUpdate();
 }
@@ -69,15 +86,56 @@ void GLGE::Graphic::Backend::OGL::Buffer::write(void* data, uint64_t dataSize, u
     std::unique_lock lock(m_dataMtx);
 
     //quick bounds check
-    if (!m_data || offset + dataSize > m_size) return;
+    if (offset + dataSize > m_size) return;
+
+    //write-through buffers only store the written bytes until the next update
+    if (m_writeThrough) {
+        addPendingWrite(data, dataSize, offset);
+        queueUpdate();
+        return;
+    }
+    //sanity check that CPU side data exists
+    if (!m_data) {return;}
 
     //copy over the data
     memcpy((uint8_t*)m_data + offset, data, dataSize);
+    //only the written region needs to be uploaded
+    markDirty(offset, dataSize);
 
     //queue a data write
     queueUpdate();
 }
 
+void GLGE::Graphic::Backend::OGL::Buffer::copy(API::Buffer* src, uint64_t srcOffset, uint64_t dstOffset, uint64_t size) noexcept
+{
+    OGL::Buffer* source = (OGL::Buffer*)src;
+
+    //write-through buffers have no CPU side data to copy, so the copy always happens on the GPU
+    if (m_writeThrough || source->m_writeThrough) {
+        //first, move all pending data to the GPU
+        source->update();
+        if (source != this) {update();}
+        //then, copy the region
+        if (m_buff && source->m_buff && ((srcOffset + size) <= source->m_currSize) && ((dstOffset + size) <= m_currSize)) {
+            glCopyNamedBufferSubData(source->m_buff, m_buff, srcOffset, dstOffset, size);
+        }
+        return;
+    }
+
+    //keep the CPU side data in sync
+    copyData(src, srcOffset, dstOffset, size);
+
+    //the GPU side can only be copied if both GPU buffers hold the current data
+    if (m_buff && source->m_buff && (m_currSize == m_size) && (source->m_currSize == source->m_size) && 
+        !m_queued.load(std::memory_order_acquire) && !source->m_queued.load(std::memory_order_acquire)) {
+        //copy the region on the GPU
+        glCopyNamedBufferSubData(source->m_buff, m_buff, srcOffset, dstOffset, size);
+    } else {
+        //else, upload the data with the next update
+        queueUpdate();
+    }
+}
+
 void GLGE::Graphic::Backend::OGL::Buffer::forceCreate()
 {
     //create the OpenGL buffer
@@ -97,21 +155,90 @@ void GLGE::Graphic::Backend::OGL::Buffer::update() noexcept
         //if it does not exist, resize the buffer
         glCreateBuffers(1, &m_buff);
         m_currSize = 0;
-        m_mappedPtr = nullptr;
     }
     //if the size is not correct, resize
     if (m_size != m_currSize) {
-        //store the OpenGL flags
-        GLenum flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
-        //re-size the data
-        glNamedBufferStorage(m_buff, m_size, m_data, flags);
-        //map the data
-        m_mappedPtr = glMapNamedBufferRange(m_buff, 0, m_size, flags);
+        //immutable storage can't be re-sized, so existing data is moved to a new buffer
+        uint32_t oldBuff = 0;
+        uint64_t oldSize = m_currSize;
+        if (oldSize) {
+            oldBuff = m_buff;
+            glCreateBuffers(1, &m_buff);
+        }
+        //create the storage, all data arrives through GPU copies
+        glNamedBufferStorage(m_buff, m_size, nullptr, 0);
         //store the new size
         m_currSize = m_size;
+
+        if (oldBuff) {
+            //the data that is kept is already on the GPU
+            uint64_t kept = std::min(oldSize, m_size);
+            //changes to the kept data are written to the old buffer first, the copy then moves them along
+            uploadDirty(oldBuff, 0, kept);
+            glCopyNamedBufferSubData(oldBuff, m_buff, 0, 0, kept);
+            //only the new region is uploaded directly
+            if (m_data && (m_size > kept)) 
+            {uploadBytes(m_buff, kept, ((uint8_t*)m_data) + kept, m_size - kept);}
+            //commands recorded from now on use the new buffer, the old one is deleted once the GPU is done with it
+            glDeleteBuffers(1, &oldBuff);
+        } else if (m_data) {
+            //the whole buffer is uploaded
+            uploadBytes(m_buff, 0, m_data, m_size);
+        }
     } else 
     {
-        //just copy the data over
-        memcpy(m_mappedPtr, m_data, m_currSize);
+        //just copy the changed regions over
+        uploadDirty(m_buff, 0, m_currSize);
+    }
+    //everything is up to date now
+    m_dirty.clear();
+
+    //apply the writes to a write-through buffer in the order they happened
+    for (const PendingWrite& write : m_pendingWrites) {
+        //writes may reach over the end if the buffer shrunk
+        if (write.offset >= m_size) {continue;}
+        uint64_t size = std::min(write.size, m_size - write.offset);
+        //zeroed regions are cleared on the GPU
+        if (write.start == CLEAR) 
+        {glClearNamedBufferSubData(m_buff, GL_R8UI, write.offset, size, GL_RED_INTEGER, GL_UNSIGNED_BYTE, nullptr);}
+        else 
+        {uploadBytes(m_buff, write.offset, m_pendingBytes.data() + write.start, size);}
+    }
+    //the pending writes are on their way to the GPU, so their storage is released
+    if (!m_pendingWrites.empty()) {
+        std::vector<PendingWrite>().swap(m_pendingWrites);
+        std::vector<uint8_t>().swap(m_pendingBytes);
     }
-}
\ No newline at end of file
+}
+
+void GLGE::Graphic::Backend::OGL::Buffer::uploadDirty(uint32_t buffer, uint64_t begin, uint64_t end) noexcept
+{
+    //copy all changed regions that lie in the requested region
+    for (const DirtyRange& range : m_dirty) {
+        //ranges may reach over the end if the buffer shrunk
+        if (range.start >= end) {break;}
+        if (range.end <= begin) {continue;}
+        uint64_t start = std::max(range.start, begin);
+        uploadBytes(buffer, start, ((uint8_t*)m_data) + start, std::min(range.end, end) - start);
+    }
+}
+
+void GLGE::Graphic::Backend::OGL::Buffer::uploadBytes(uint32_t buffer, uint64_t offset, const void* src, uint64_t size) noexcept
+{
+    //stage the data, the GPU copy is ordered with all commands that use the buffer
+    StagingRing::Allocation stage = StagingRing::allocate(size);
+    if (stage.mapped) {
+        memcpy(stage.mapped, src, size);
+        glCopyNamedBufferSubData(stage.buffer, buffer, stage.offset, offset, size);
+    } else {
+        //if the ring is full, stage the data in a temporary buffer
+        //writing to the mapped memory directly could be overwritten by copies that are still pending
+        uint32_t temp = 0;
+        glCreateBuffers(1, &temp);
+        glNamedBufferStorage(temp, size, src, 0);
+        glCopyNamedBufferSubData(temp, buffer, 0, offset, size);
+        //OpenGL keeps the buffer alive until the copy finished
+        glDeleteBuffers(1, &temp);
+    }
+    m_uploadedBytes.fetch_add(size, std::memory_order_relaxed);
+}
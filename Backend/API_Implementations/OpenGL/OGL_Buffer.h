@@ -60,6 +60,20 @@ public:
      */
     virtual void write(void* data, uint64_t dataSize, uint64_t offset) noexcept override;
 
+    /**
+     * @brief copy a region of another buffer (or this buffer) into this buffer
+     * 
+     * If both GPU buffers are up to date the region is copied on the GPU, so no upload is needed. 
+     * 
+     * @warning this must be called from the thread that owns the OpenGL context
+     * 
+     * @param src the buffer to copy from (must be an OpenGL buffer)
+     * @param srcOffset the offset into the source buffer in bytes
+     * @param dstOffset the offset into this buffer in bytes
+     * @param size the amount of bytes to copy
+     */
+    virtual void copy(API::Buffer* src, uint64_t srcOffset, uint64_t dstOffset, uint64_t size) noexcept override;
+
     /**
      * @brief Get the Buffer
      * 
@@ -84,12 +98,37 @@ protected:
      */
     virtual void update() noexcept override;
 
+    /**
+     * @brief copy the changed regions of the CPU side data that lie in a specific region to an OpenGL buffer
+     * 
+     * @warning the data mutex must be locked by the caller
+     * 
+     * @param buffer the OpenGL buffer to copy to
+     * @param begin the first byte of the region to copy
+     * @param end the byte after the last byte of the region to copy
+     */
+    void uploadDirty(uint32_t buffer, uint64_t begin, uint64_t end) noexcept;
+
+    /**
+     * @brief copy some bytes to a region of an OpenGL buffer
+     * 
+     * The data is staged in the staging ring and moved with a GPU copy. 
+     * If the ring is full, the data is staged in a temporary buffer instead, so the copy stays ordered with 
+     * all other copies into the buffer and all commands that were already submitted. 
+     * 
+     * @warning the data mutex must be locked by the caller
+     * 
+     * @param buffer the OpenGL buffer to copy to
+     * @param offset the offset of the region in the OpenGL buffer in bytes
+     * @param src the bytes to copy
+     * @param size the size of the region in bytes
+     */
+    void uploadBytes(uint32_t buffer, uint64_t offset, const void* src, uint64_t size) noexcept;
+
     //store the OpenGL buffer
     uint32_t m_buff = 0;
     //store the current buffer size
     uint64_t m_currSize = 0;
-    //store a pointer to the mapped data
-    void* m_mappedPtr = nullptr;
 
 };
 
@@ -0,0 +1,108 @@
+/**
+ * @file OGL_BufferPool.cpp
+ * @author DM8AT
+ * @brief implement the pool for small OpenGL buffers
+ * @version 0.1
+ * @date 2025-11-15
+ * 
+ * @copyright Copyright (c) 2025
+ * 
+ */
+//add the buffer pool
+#include "OGL_BufferPool.h"
+//add the instance for the frame timeline
+#include "OGL_Instance.h"
+//add std::max
+#include <algorithm>
+//add bit operations for the size classes
+#include <bit>
+//add OpenGL
+#include "glad/glad.h"
+
+//use the OpenGL namespace
+using namespace GLGE::Graphic::Backend::OGL;
+
+uint8_t BufferPool::getSizeClass(uint64_t size) noexcept
+{
+    //the smallest class holds everything up to the minimal size
+    if (size <= MIN_SLICE_SIZE) {return 0;}
+    //each class doubles the size
+    return (uint8_t)(std::bit_width((size - 1) / MIN_SLICE_SIZE));
+}
+
+BufferPool::Slice BufferPool::allocate(uint64_t size) noexcept
+{
+    //thread safety
+    std::unique_lock lock(s_mtx);
+
+    //the slices must respect the binding alignment of uniform and shader storage buffers
+    if (!s_alignment) {
+        GLint ubo = 0, ssbo = 0;
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &ubo);
+        glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &ssbo);
+        s_alignment = std::max<uint64_t>(std::max<uint64_t>(ubo, ssbo), 1);
+    }
+
+    //re-use all released slices the GPU is done with
+    uint64_t completed = Instance::getCompletedFrame();
+    uint64_t done = 0;
+    while ((done < s_pending.size()) && (s_pending[done].frame <= completed)) {
+        s_free[getSizeClass(s_pending[done].slice.size)].push_back(s_pending[done].slice);
+        ++done;
+    }
+    s_pending.erase(s_pending.begin(), s_pending.begin() + done);
+
+    //first, try a free slice of the correct size
+    uint8_t sizeClass = getSizeClass(size);
+    if (s_free[sizeClass].size()) {
+        Slice slice = s_free[sizeClass].back();
+        s_free[sizeClass].pop_back();
+        return slice;
+    }
+
+    //else, cut a new slice from the last chunk
+    //as the slice sizes are powers of two and at least as large as the alignment, only the start needs to be aligned
+    uint64_t sliceSize = MIN_SLICE_SIZE << sizeClass;
+    uint64_t start = s_chunks.size() ? (((s_chunks.back().used + s_alignment - 1) / s_alignment) * s_alignment) : CHUNK_SIZE;
+    if ((start + sliceSize) > CHUNK_SIZE) {
+        //the last chunk is full, so create a new one
+        Chunk chunk{0, nullptr, 0};
+        glCreateBuffers(1, &chunk.buffer);
+        //store the flags to apply
+        GLenum flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glNamedBufferStorage(chunk.buffer, CHUNK_SIZE, nullptr, flags);
+        chunk.mapped = glMapNamedBufferRange(chunk.buffer, 0, CHUNK_SIZE, flags);
+        s_chunks.push_back(chunk);
+        start = 0;
+    }
+
+    //hand out the slice
+    Chunk& chunk = s_chunks.back();
+    chunk.used = start + sliceSize;
+    return {chunk.buffer, start, sliceSize, ((uint8_t*)chunk.mapped) + start};
+}
+
+void BufferPool::release(const Slice& slice) noexcept
+{
+    //empty slices are not part of the pool
+    if (!slice.size) {return;}
+    //thread safety
+    std::unique_lock lock(s_mtx);
+    //the slice may be used until the GPU finished the current frame
+    s_pending.push_back({slice, Instance::getCurrentFrame()});
+}
+
+void BufferPool::clear() noexcept
+{
+    //thread safety
+    std::unique_lock lock(s_mtx);
+    //delete all OpenGL buffers
+    for (const Chunk& chunk : s_chunks) {
+        glUnmapNamedBuffer(chunk.buffer);
+        glDeleteBuffers(1, &chunk.buffer);
+    }
+    s_chunks.clear();
+    //all slices are gone
+    for (uint8_t i = 0; i < SIZE_CLASS_COUNT; ++i) {s_free[i].clear();}
+    s_pending.clear();
+}
@@ -0,0 +1,179 @@
+/**
+ * @file OGL_BufferPool.h
+ * @author DM8AT
+ * @brief define a pool that stores small buffers as slices of a few large OpenGL buffers
+ * @version 0.1
+ * @date 2025-11-15
+ * 
+ * @copyright Copyright (c) 2025
+ * 
+ */
+//header guard
+#ifndef _GLGE_GRAPHIC_BACKEND_API_IMPL_OGL_OGL_BUFFER_POOL_
+#define _GLGE_GRAPHIC_BACKEND_API_IMPL_OGL_OGL_BUFFER_POOL_
+
+//add all types
+#include "../../../../GLGE_Core/Types.h"
+
+//only available for C++
+#if __cplusplus
+
+//add vectors to store the chunks and free slices
+#include <vector>
+//add a mutex for thread safety
+#include <mutex>
+
+//use the namespace GLGE::Graphic::Backend::OGL
+namespace GLGE::Graphic::Backend::OGL
+{
+
+/**
+ * @brief a pool that stores small buffers as slices of a few large, persistently mapped OpenGL buffers
+ * 
+ * Slices are bound using `glBindBufferRange`, so thousands of small buffers only need a handful of OpenGL buffers.
+ * The slice sizes are powers of two, so each size uses its own free list.
+ */
+class BufferPool
+{
+public:
+
+    /**
+     * @brief store a single slice of a pool buffer
+     */
+    struct Slice {
+        //the OpenGL buffer the slice lives in
+        uint32_t buffer = 0;
+        //the offset of the slice in the OpenGL buffer in bytes
+        uint64_t offset = 0;
+        //the size of the slice in bytes
+        uint64_t size = 0;
+        //a pointer to the mapped memory of the slice
+        void* mapped = nullptr;
+    };
+
+    /**
+     * @brief the size of the smallest slice in bytes
+     */
+    inline static constexpr uint64_t MIN_SLICE_SIZE = 256;
+    /**
+     * @brief the size of the largest slice in bytes, larger buffers use their own OpenGL buffer
+     */
+    inline static constexpr uint64_t MAX_SLICE_SIZE = 64 * 1024;
+    /**
+     * @brief the size of a single OpenGL buffer of the pool in bytes
+     */
+    inline static constexpr uint64_t CHUNK_SIZE = 4 * 1024 * 1024;
+
+    /**
+     * @brief Set if small buffers are stored in the pool
+     * 
+     * This only affects buffers that are created or re-sized afterwards.
+     * 
+     * @param enabled true : small buffers are pooled | false : each buffer uses its own OpenGL buffer
+     */
+    inline static void setEnabled(bool enabled) noexcept {s_enabled = enabled;}
+
+    /**
+     * @brief check if small buffers are stored in the pool
+     * 
+     * @return true : small buffers are pooled | false : each buffer uses its own OpenGL buffer
+     */
+    inline static bool isEnabled() noexcept {return s_enabled;}
+
+    /**
+     * @brief check if a buffer of a specific size is stored in the pool
+     * 
+     * @param size the size of the buffer in bytes
+     * @return true : the buffer is stored as a slice
+     * @return false : the buffer needs its own OpenGL buffer
+     */
+    inline static bool isPooled(uint64_t size) noexcept {return s_enabled && (size > 0) && (size <= MAX_SLICE_SIZE);}
+
+    /**
+     * @brief get a slice that can hold a specific amount of bytes
+     * @warning this must be called from the thread that owns the OpenGL context
+     * 
+     * @param size the minimal size of the slice in bytes
+     * @return Slice the new slice
+     */
+    static Slice allocate(uint64_t size) noexcept;
+
+    /**
+     * @brief give a slice back to the pool
+     * 
+     * The slice is only re-used after the GPU finished the frame that is currently recorded.
+     * 
+     * @param slice the slice to release
+     */
+    static void release(const Slice& slice) noexcept;
+
+    /**
+     * @brief delete all OpenGL buffers of the pool
+     * @warning this must be called from the thread that owns the OpenGL context and only if no slice is used anymore
+     */
+    static void clear() noexcept;
+
+    /**
+     * @brief Get the amount of OpenGL buffers the pool uses
+     * 
+     * @return uint64_t the amount of OpenGL buffers
+     */
+    inline static uint64_t getChunkCount() noexcept {return s_chunks.size();}
+
+protected:
+
+    /**
+     * @brief store a single OpenGL buffer of the pool
+     */
+    struct Chunk {
+        //the OpenGL buffer
+        uint32_t buffer;
+        //a pointer to the persistently mapped data
+        void* mapped;
+        //the amount of bytes that were handed out
+        uint64_t used;
+    };
+
+    /**
+     * @brief store a slice that was released but may still be used by the GPU
+     */
+    struct PendingRelease {
+        //the released slice
+        Slice slice;
+        //the last frame that may use the slice
+        uint64_t frame;
+    };
+
+    /**
+     * @brief the amount of slice sizes (powers of two from MIN_SLICE_SIZE to MAX_SLICE_SIZE)
+     */
+    inline static constexpr uint8_t SIZE_CLASS_COUNT = 9;
+
+    /**
+     * @brief get the index of the size class that holds a specific size
+     * 
+     * @param size the size in bytes
+     * @return uint8_t the index of the size class
+     */
+    static uint8_t getSizeClass(uint64_t size) noexcept;
+
+    //store if small buffers are pooled
+    inline static bool s_enabled = false;
+    //store the offset alignment the slices must respect
+    inline static uint64_t s_alignment = 0;
+    //store all OpenGL buffers of the pool
+    inline static std::vector<Chunk> s_chunks;
+    //store the free slices of each size class
+    inline static std::vector<Slice> s_free[SIZE_CLASS_COUNT];
+    //store the released slices that may still be used by the GPU, oldest first
+    inline static std::vector<PendingRelease> s_pending;
+    //store a mutex to make the pool thread safe
+    inline static std::mutex s_mtx;
+
+};
+
+}
+
+#endif
+
+#endif
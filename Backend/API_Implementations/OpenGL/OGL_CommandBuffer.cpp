@@ -14,28 +14,513 @@
 //add OpenGL
 #include "glad/glad.h"
 
+//add OpenGL materials for the sort keys
+#include "OGL_Material.h"
+//add frontend materials and cameras for the sort keys
+#include "../../../Frontend/Material.h"
+#include "../../../Frontend/Camera.h"
+//add compute objects for the hazard tracking
+#include "../../../Frontend/Compute.h"
+//add unordered maps to rank the state of the draws
+#include <unordered_map>
+//add std::min
+#include <algorithm>
+
 //use the namespace
 using namespace GLGE::Graphic::Backend::OGL;
 
+uint8_t* CommandBuffer::grow(uint64_t size) noexcept
+{
+    //store where the new space starts
+    uint64_t start = m_size;
+    m_size += size;
+    //make sure the stream is large enough, the capacity stays when the buffer is cleared
+    if ((m_size / COMMAND_ALIGN) > m_stream.size()) {m_stream.resize(m_size / COMMAND_ALIGN);}
+    return ((uint8_t*)m_stream.data()) + start;
+}
+
 void CommandBuffer::play() noexcept
 {
     //if the command buffer is not marked as recorded, just stop
     if (!m_recorded) {return;}
 
-    //just iterate over commands and play them back
-    for (size_t i = 0; i < m_commands.size(); ++i) {
-        m_commands[i].execute();
+    //walk over the command stream and play back each command
+    const uint8_t* pos = (const uint8_t*)m_stream.data();
+    const uint8_t* end = pos + m_size;
+    while (pos < end) {
+        //read the header and get the command behind it
+        const CommandHeader* header = (const CommandHeader*)pos;
+        const void* cmd = pos + alignSize(sizeof(CommandHeader));
+        //run the command depending on its type
+        switch (header->type)
+        {
+        case CommandType::COMMAND_CUSTOM:
+            ((const Command_Custom*)cmd)->execute();
+            break;
+        case CommandType::COMMAND_CLEAR:
+            ((const Command_Clear*)cmd)->execute();
+            break;
+        case CommandType::COMMAND_BIND_MATERIAL:
+            ((const Command_BindMaterial*)cmd)->execute();
+            break;
+        case CommandType::COMMAND_DRAW_MESH:
+            ((const Command_DrawMesh*)cmd)->execute();
+            break;
+        case CommandType::COMMAND_DISPATCH_COMPUTE:
+            ((const Command_DispatchCompute*)cmd)->execute();
+            break;
+        case CommandType::COMMAND_MEMORY_BARRIER:
+            ((const Command_MemoryBarrier*)cmd)->execute();
+            break;
+        case CommandType::COMMAND_UPLOAD_BATCHES:
+            ((const Command_UploadBatches*)cmd)->execute();
+            break;
+        case CommandType::COMMAND_DRAW_MESHES_INDIRECT:
+            ((const Command_DrawMeshesIndirect*)cmd)->execute();
+            break;
+        case CommandType::COMMAND_MULTI_DRAW_MESHES:
+            ((const Command_MultiDrawMeshes*)cmd)->execute();
+            break;
+        case CommandType::COMMAND_BLIT:
+            ((const Command_Blit*)cmd)->execute();
+            break;
+        
+        default:
+            GLGE_DEBUG_ABORT("Unknown command type in command stream");
+            break;
+        }
+        //step to the next command
+        pos += header->size;
     }
 }
 
 void CommandBuffer::clear() noexcept
 {
-    //just delete all commands
-    for (auto& cmd : m_commands) {
-        cmd.destroy();
-    }
-    //clean up the RAM
-    m_commands.clear();
+    //the commands are trivially destructible, so just forget them
+    //the memory of the stream is kept for the next recording
+    m_size = 0;
+    m_count = 0;
     //this can't be recorded anymore
     m_recorded = false;
 }
+
+/**
+ * @brief get the rank of a state object in the order it first appeared in
+ * 
+ * Ranks are small, so they fit into the fields of a sort key. 
+ * 
+ * @param ranks the ranks of all known objects
+ * @param obj the object to rank
+ * @param max the maximal rank that fits into the field of the key
+ * @return uint64_t the rank of the object
+ */
+static uint64_t __rank(std::unordered_map<const void*, uint64_t>& ranks, const void* obj, uint64_t max) noexcept {
+    //add the object if it is new
+    auto pos = ranks.try_emplace(obj, ranks.size()).first;
+    //clamp the rank to the field
+    return std::min(pos->second, max);
+}
+
+/**
+ * @brief build the sort key of a draw
+ * 
+ * The key is ordered from the most to the least expensive state change: 
+ * 12 bit render target | 16 bit shader | 16 bit material | 10 bit vertex page | 10 bit index page
+ */
+static uint64_t __sortKey(uint64_t target, uint64_t shader, uint64_t material, uint64_t vertexPage, uint64_t indexPage) noexcept {
+    return (target << 52) | (shader << 36) | (material << 20) | (std::min<uint64_t>(vertexPage, 0x3FF) << 10) | std::min<uint64_t>(indexPage, 0x3FF);
+}
+
+void CommandBuffer::flushSortRun(bool sort, uint64_t& out) noexcept
+{
+    //sort the units if requested
+    if (sort && (m_sortUnits.size() > 1)) {
+        //stable least significant digit radix sort over the bytes of the keys
+        m_sortTemp.resize(m_sortUnits.size());
+        for (uint8_t shift = 0; shift < 64; shift += 8) {
+            //count the keys per bucket
+            uint64_t count[256] = {0};
+            for (const SortUnit& unit : m_sortUnits) {++count[(unit.key >> shift) & 0xFF];}
+            //skip the byte if all keys share it
+            if (count[(m_sortUnits[0].key >> shift) & 0xFF] == m_sortUnits.size()) {continue;}
+            //compute the start of each bucket
+            uint64_t start = 0;
+            for (uint64_t& c : count) {uint64_t n = c; c = start; start += n;}
+            //scatter the units, this keeps the order of equal keys
+            for (const SortUnit& unit : m_sortUnits) {m_sortTemp[count[(unit.key >> shift) & 0xFF]++] = unit;}
+            m_sortUnits.swap(m_sortTemp);
+        }
+    }
+    //copy the units to the sorted stream
+    for (const SortUnit& unit : m_sortUnits) {
+        memcpy(((uint8_t*)m_sortStream.data()) + out, ((const uint8_t*)m_stream.data()) + unit.offset, unit.size);
+        out += unit.size;
+    }
+    m_sortUnits.clear();
+}
+
+void CommandBuffer::sortDraws() noexcept
+{
+    //make sure the sorted stream can hold all commands
+    if (m_sortStream.size() < m_stream.size()) {m_sortStream.resize(m_stream.size());}
+
+    //store the ranks of the state objects of the current run
+    std::unordered_map<const void*, uint64_t> targets, shaders, materials;
+    //store the type of the units in the current run, simple and indirect draws are never mixed
+    //(indirect draws bind their own render target, simple draws use the render target that is bound)
+    CommandType runType = CommandType::COMMAND_CUSTOM;
+    //store the write position in the sorted stream
+    uint64_t out = 0;
+    //walk over the command stream
+    const uint8_t* data = (const uint8_t*)m_stream.data();
+    uint64_t pos = 0;
+    while (pos < m_size) {
+        //read the header and get the command behind it
+        const CommandHeader* header = (const CommandHeader*)(data + pos);
+        const void* cmd = data + pos + alignSize(sizeof(CommandHeader));
+
+        //check if the command starts a unit
+        if ((header->type == CommandType::COMMAND_BIND_MATERIAL) || (header->type == CommandType::COMMAND_DRAW_MESHES_INDIRECT)) {
+            //a new kind of unit ends the run
+            if (header->type != runType) {
+                flushSortRun(true, out);
+                targets.clear(); shaders.clear(); materials.clear();
+                runType = header->type;
+            }
+
+            //collect the unit
+            SortUnit unit{0, pos, header->size};
+            if (header->type == CommandType::COMMAND_BIND_MATERIAL) {
+                //the unit contains all following draws of the bound material
+                const Command_BindMaterial* bind = (const Command_BindMaterial*)cmd;
+                uint64_t vertexPage = 0, indexPage = 0;
+                bool first = true;
+                while ((unit.offset + unit.size) < m_size) {
+                    const CommandHeader* next = (const CommandHeader*)(data + unit.offset + unit.size);
+                    const Command_DrawMesh* draw = (const Command_DrawMesh*)(((const uint8_t*)next) + alignSize(sizeof(CommandHeader)));
+                    if ((next->type != CommandType::COMMAND_DRAW_MESH) || (draw->material != bind->material)) {break;}
+                    //the pages of the first draw are used for the key
+                    if (first) {vertexPage = draw->rMesh->getVertexPointer().page; indexPage = draw->rMesh->getIndexPointer().page; first = false;}
+                    unit.size += next->size;
+                }
+                //simple draws use the bound render target, so it is the same for all units
+                unit.key = __sortKey(0, __rank(shaders, bind->material->getMaterial()->getShader(), 0xFFFF), 
+                                     __rank(materials, bind->material, 0xFFFF), vertexPage, indexPage);
+            } else {
+                //indirect draws bind everything they need
+                const Command_DrawMeshesIndirect* draw = (const Command_DrawMeshesIndirect*)cmd;
+                //a later draw may read what an earlier draw rendered to another target, so a new target ends the run
+                const void* renderTarget = ((Camera*)draw->camera)->getTarget().target;
+                if (targets.size() && !targets.contains(renderTarget)) {
+                    flushSortRun(true, out);
+                    targets.clear(); shaders.clear(); materials.clear();
+                }
+                unit.key = __sortKey(__rank(targets, renderTarget, 0xFFF), 
+                                     __rank(shaders, draw->material->getMaterial()->getShader(), 0xFFFF), 
+                                     __rank(materials, draw->material, 0xFFFF), draw->vertexPage, draw->indexPage);
+            }
+            m_sortUnits.push_back(unit);
+            pos += unit.size;
+            continue;
+        }
+
+        //any other command ends the run
+        //a draw outside of a unit relies on the material that was bound last, so the run before it must keep its order
+        flushSortRun(header->type != CommandType::COMMAND_DRAW_MESH, out);
+        targets.clear(); shaders.clear(); materials.clear();
+        runType = CommandType::COMMAND_CUSTOM;
+        //copy the command as it is
+        memcpy(((uint8_t*)m_sortStream.data()) + out, data + pos, header->size);
+        out += header->size;
+        pos += header->size;
+    }
+    //copy the last run
+    flushSortRun(true, out);
+
+    //the sorted stream is the new command stream
+    m_stream.swap(m_sortStream);
+}
+
+void CommandBuffer::append(const CommandBuffer& other) noexcept
+{
+    //sanity check if the state is correct
+    GLGE_DEBUG_ASSERT("Adding new commands to a command buffer that is marked as recorded", m_recorded);
+    //nothing to copy for empty buffers
+    if (!other.m_size) {return;}
+    //the streams are aligned the same, so just copy the bytes
+    memcpy(grow(other.m_size), other.m_stream.data(), other.m_size);
+    m_count += other.m_count;
+}
+
+void CommandBuffer::optimize() noexcept
+{
+    //make sure the optimized stream can hold all commands, commands are only ever removed or shrunk
+    if (m_sortStream.size() < m_stream.size()) {m_sortStream.resize(m_stream.size());}
+    m_removed = 0;
+    m_merged = 0;
+
+    //store the material that is currently bound (nullptr if unknown)
+    OGL::Material* bound = nullptr;
+    //store the offset of the last written command in the optimized stream
+    uint64_t last = UINT64_MAX;
+    //store the write position in the optimized stream and the amount of written commands
+    uint64_t out = 0;
+    uint64_t count = 0;
+    //get the start of both streams
+    const uint8_t* data = (const uint8_t*)m_stream.data();
+    uint8_t* dst = (uint8_t*)m_sortStream.data();
+    //store the size of a header
+    constexpr uint64_t headerSize = alignSize(sizeof(CommandHeader));
+
+    //walk over the command stream
+    uint64_t pos = 0;
+    while (pos < m_size) {
+        //read the header and get the command behind it
+        const CommandHeader* header = (const CommandHeader*)(data + pos);
+        const void* cmd = data + pos + headerSize;
+        //get the last written command
+        const CommandHeader* prev = (last != UINT64_MAX) ? (const CommandHeader*)(dst + last) : nullptr;
+
+        switch (header->type)
+        {
+        case CommandType::COMMAND_BIND_MATERIAL:
+            //binding the bound material again does nothing
+            if (((const Command_BindMaterial*)cmd)->material == bound) {++m_removed; pos += header->size; continue;}
+            bound = ((const Command_BindMaterial*)cmd)->material;
+            break;
+
+        case CommandType::COMMAND_DRAW_MESH: {
+            //collect all following draws of the same material from the same pages
+            const Command_DrawMesh* draw = (const Command_DrawMesh*)cmd;
+            uint64_t end = pos + header->size;
+            uint32_t meshCount = 1;
+            while (end < m_size) {
+                const CommandHeader* next = (const CommandHeader*)(data + end);
+                const Command_DrawMesh* nextDraw = (const Command_DrawMesh*)(data + end + headerSize);
+                if ((next->type != CommandType::COMMAND_DRAW_MESH) || (nextDraw->material != draw->material) || 
+                    (nextDraw->rMesh->getVertexPointer().page != draw->rMesh->getVertexPointer().page) || 
+                    (nextDraw->rMesh->getIndexPointer().page != draw->rMesh->getIndexPointer().page)) 
+                {break;}
+                end += next->size;
+                ++meshCount;
+            }
+            //a single draw is kept as it is
+            if (meshCount == 1) {break;}
+
+            //write a single multi draw with all meshes behind it
+            //the multi draw is never larger than the draws it replaces
+            uint64_t size = headerSize + alignSize(sizeof(Command_MultiDrawMeshes)) + alignSize(meshCount * sizeof(API::RenderMesh*));
+            new (dst + out) CommandHeader{(uint32_t)size, Command_MultiDrawMeshes::TYPE};
+            new (dst + out + headerSize) Command_MultiDrawMeshes(draw->material, meshCount);
+            API::RenderMesh** meshes = (API::RenderMesh**)(dst + out + headerSize + alignSize(sizeof(Command_MultiDrawMeshes)));
+            for (uint64_t p = pos, i = 0; p < end; p += ((const CommandHeader*)(data + p))->size, ++i) 
+            {meshes[i] = ((const Command_DrawMesh*)(data + p + headerSize))->rMesh;}
+            m_merged += meshCount;
+            last = out;
+            out += size;
+            ++count;
+            pos = end;
+            continue;
+        }
+
+        case CommandType::COMMAND_MEMORY_BARRIER:
+            //a barrier directly behind a barrier is merged into it
+            if (prev && (prev->type == CommandType::COMMAND_MEMORY_BARRIER)) {
+                ((Command_MemoryBarrier*)(dst + last + headerSize))->bits |= ((const Command_MemoryBarrier*)cmd)->bits;
+                ++m_removed;
+                pos += header->size;
+                continue;
+            }
+            break;
+
+        case CommandType::COMMAND_CLEAR:
+            //a clear that is directly overwritten by a clear of the same attachment does nothing, so replace it
+            if (prev && (prev->type == CommandType::COMMAND_CLEAR)) {
+                const Command_Clear* clear = (const Command_Clear*)cmd;
+                const Command_Clear* prevClear = (const Command_Clear*)(((const uint8_t*)prev) + headerSize);
+                if ((clear->fbuff == prevClear->fbuff) && (clear->buffType == prevClear->buffType) && (clear->buffId == prevClear->buffId)) {
+                    memcpy(dst + last, data + pos, header->size);
+                    ++m_removed;
+                    pos += header->size;
+                    continue;
+                }
+            }
+            break;
+
+        case CommandType::COMMAND_CUSTOM:
+        case CommandType::COMMAND_DISPATCH_COMPUTE:
+        case CommandType::COMMAND_DRAW_MESHES_INDIRECT:
+            //these change the bound shader and resources, so the bound material is unknown afterwards
+            bound = nullptr;
+            break;
+
+        default:
+            break;
+        }
+
+        //keep the command as it is
+        memcpy(dst + out, data + pos, header->size);
+        last = out;
+        out += header->size;
+        ++count;
+        pos += header->size;
+    }
+
+    //the optimized stream is the new command stream
+    m_stream.swap(m_sortStream);
+    m_size = out;
+    m_count = count;
+}
+
+/**
+ * @brief store a single memory access of a command for the hazard tracking
+ */
+struct __Access {
+    //the frontend buffer or texture that is accessed
+    const void* resource;
+    //the OpenGL barrier bit that makes writes visible to the access
+    uint32_t barrier;
+    //true if the access may write to the resource
+    bool write;
+};
+
+/**
+ * @brief check if a buffer pointer is just a marker for a skipped slot
+ * 
+ * @param buffer the buffer pointer to check
+ * @return true : the pointer marks a skipped slot | false : the pointer is an actual buffer
+ */
+static inline bool __isSkipSlot(const ::Buffer* buffer) noexcept
+{return (((uint64_t)buffer) >> 8) == (GLGE_SKIP_SLOT_MARKER >> 8);}
+
+/**
+ * @brief collect all memory accesses of a compute object
+ * 
+ * @param accesses the list to add the accesses to
+ * @param cmp the compute object
+ */
+static void __collectAccesses(std::vector<__Access>& accesses, const Compute* cmp) noexcept {
+    //add all buffers, only shader storage buffers may be written
+    for (uint8_t i = 0; i < cmp->getBufferCount(); ++i) {
+        const ::Buffer* buffer = cmp->getBuffer(i);
+        if (__isSkipSlot(buffer)) {continue;}
+        uint32_t barrier = (buffer->getType() == GLGE_BUFFER_TYPE_UNIFORM) ? GL_UNIFORM_BARRIER_BIT : GL_SHADER_STORAGE_BARRIER_BIT;
+        accesses.push_back({buffer, barrier, cmp->isBufferWritten(i)});
+    }
+    //textures are only sampled
+    for (uint8_t i = 0; i < cmp->getTextureCount(); ++i) {accesses.push_back({cmp->getTexture(i), GL_TEXTURE_FETCH_BARRIER_BIT, false});}
+}
+
+/**
+ * @brief collect all memory accesses of a material
+ * 
+ * @param accesses the list to add the accesses to
+ * @param mat the frontend material
+ */
+static void __collectAccesses(std::vector<__Access>& accesses, const ::Material* mat) noexcept {
+    //add all buffers, only shader storage buffers may be written
+    for (uint8_t i = 0; i < mat->getUsedBufferCount(); ++i) {
+        const ::Buffer* buffer = mat->getUsedBuffers()[i];
+        if (__isSkipSlot(buffer)) {continue;}
+        uint32_t barrier = (buffer->getType() == GLGE_BUFFER_TYPE_UNIFORM) ? GL_UNIFORM_BARRIER_BIT : GL_SHADER_STORAGE_BARRIER_BIT;
+        accesses.push_back({buffer, barrier, mat->isBufferWritten(i)});
+    }
+    //textures are only sampled
+    for (uint8_t i = 0; i < mat->getUsedTextureCount(); ++i) {accesses.push_back({mat->getUsedTextures()[i], GL_TEXTURE_FETCH_BARRIER_BIT, false});}
+}
+
+void CommandBuffer::insertBarriers() noexcept
+{
+    //store the size of a header
+    constexpr uint64_t headerSize = alignSize(sizeof(CommandHeader));
+    //store the size of an inserted barrier
+    constexpr uint64_t barrierSize = headerSize + alignSize(sizeof(Command_MemoryBarrier));
+
+    //store all resources with pending writes and the barrier bits that were issued since they were written
+    std::unordered_map<const void*, uint32_t> pending;
+    //store the accesses of the current command
+    std::vector<__Access> accesses;
+    m_inserted = 0;
+    //store the write position in the new stream and the amount of written commands
+    uint64_t out = 0;
+    uint64_t count = 0;
+    //the commands are played every frame, so writes at the end are pending at the start
+    //because of that, the stream is tracked twice and only written during the second pass
+    for (uint8_t pass = 0; pass < 2; ++pass) {
+        uint64_t pos = 0;
+        while (pos < m_size) {
+            //read the header and get the command behind it
+            const CommandHeader* header = (const CommandHeader*)(((const uint8_t*)m_stream.data()) + pos);
+            const void* cmd = ((const uint8_t*)header) + headerSize;
+
+            //collect the accesses of the command
+            accesses.clear();
+            uint32_t need = 0;
+            switch (header->type)
+            {
+            case CommandType::COMMAND_DISPATCH_COMPUTE:
+                __collectAccesses(accesses, (const Compute*)((const Command_DispatchCompute*)cmd)->compute);
+                break;
+            case CommandType::COMMAND_BIND_MATERIAL:
+                __collectAccesses(accesses, ((const Command_BindMaterial*)cmd)->material->getMaterial());
+                break;
+            case CommandType::COMMAND_DRAW_MESHES_INDIRECT: {
+                const Command_DrawMeshesIndirect* draw = (const Command_DrawMeshesIndirect*)cmd;
+                for (uint32_t i = 0; i < draw->shaderCount; ++i) {__collectAccesses(accesses, (const Compute*)draw->getShaders()[i]);}
+                accesses.push_back({((Camera*)draw->camera)->getBuffer(), GL_UNIFORM_BARRIER_BIT, false});
+                __collectAccesses(accesses, draw->material->getMaterial());
+                break;
+            }
+            case CommandType::COMMAND_MEMORY_BARRIER:
+                //an explicit barrier makes the writes visible to its accesses
+                for (auto& [resource, issued] : pending) {issued |= ((const Command_MemoryBarrier*)cmd)->bits;}
+                break;
+            case CommandType::COMMAND_CUSTOM:
+                //custom commands may access anything
+                for (auto& [resource, issued] : pending) {if (issued != GL_ALL_BARRIER_BITS) {need = GL_ALL_BARRIER_BITS;}}
+                break;
+
+            default:
+                break;
+            }
+
+            //a read or write of data that is written but not visible to the access is a hazard
+            for (const __Access& access : accesses) {
+                auto it = pending.find(access.resource);
+                if (it != pending.end()) {need |= access.barrier & ~it->second;}
+            }
+
+            //only the second pass writes the new stream
+            uint64_t size = header->size + (need ? barrierSize : 0);
+            if (pass && ((out + size) > m_sortStream.size() * COMMAND_ALIGN)) 
+            {m_sortStream.resize(std::max<uint64_t>((out + size) / COMMAND_ALIGN, m_sortStream.size() * 2));}
+            uint8_t* dst = (uint8_t*)m_sortStream.data();
+
+            //insert a barrier in front of the command if needed
+            if (need) {
+                for (auto& [resource, issued] : pending) {issued |= need;}
+                if (pass) {
+                    new (dst + out) CommandHeader{(uint32_t)barrierSize, Command_MemoryBarrier::TYPE};
+                    new (dst + out + headerSize) Command_MemoryBarrier(need);
+                    out += barrierSize;
+                    ++count;
+                    ++m_inserted;
+                }
+            }
+            //copy the command
+            if (pass) {
+                memcpy(dst + out, header, header->size);
+                out += header->size;
+                ++count;
+            }
+            //the written resources are pending now
+            for (const __Access& access : accesses) {if (access.write) {pending[access.resource] = 0;}}
+            pos += header->size;
+        }
+    }
+
+    //the new stream is the command stream
+    m_stream.swap(m_sortStream);
+    m_size = out;
+    m_count = count;
+}
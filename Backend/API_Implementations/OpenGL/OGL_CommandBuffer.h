@@ -25,24 +25,40 @@
 //only available for C++
 #if __cplusplus
 
+//add vectors for the command stream
+#include <vector>
+//add type traits to check the commands
+#include <type_traits>
+
 //use the namespace GLGE::Graphic::Backend::OGL
 namespace GLGE::Graphic::Backend::OGL
 {
 
 /**
  * @brief a command buffer just contains a list of commands to execute
+ * 
+ * The commands are stored back to back in a single stream of bytes. Each command is a plain structure behind a small header 
+ * that stores its type and size, and playing the buffer walks the stream and switches over the type. 
+ * Clearing the buffer keeps the memory of the stream, so re-recording does not allocate. 
  */
 class CommandBuffer final : public GLGE::Graphic::Backend::API::CommandBuffer
 {
 public:
 
     /**
-     * @brief Construct a new CommandContainer Buffer
+     * @brief Construct a new Command Buffer
      */
     CommandBuffer() = default;
 
     /**
-     * @brief Destroy the CommandContainer Buffer
+     * @brief Construct a new Command Buffer by moving from another one
+     * 
+     * @param other the command buffer to move from
+     */
+    CommandBuffer(CommandBuffer&& other) noexcept = default;
+
+    /**
+     * @brief Destroy the Command Buffer
      */
     virtual ~CommandBuffer() {}
 
@@ -64,14 +80,115 @@ public:
      * @param args the actual arguments to pass
      */
     template <typename T, typename ...Args>
-    void record(Args&& ...args) {
+    inline void record(Args&& ...args) noexcept
+    {recordExtended<T>(nullptr, 0, std::forward<Args>(args) ...);}
+
+    /**
+     * @brief record a new command with extra data that is stored directly behind the command
+     * 
+     * @tparam T the type of command to record
+     * @tparam Args the arguments to pass to the command
+     * @param extra a pointer to the extra data to copy behind the command
+     * @param extraSize the size of the extra data in bytes
+     * @param args the actual arguments to pass
+     */
+    template <typename T, typename ...Args>
+    void recordExtended(const void* extra, uint32_t extraSize, Args&& ...args) noexcept {
+        //sanity check the command type (static to do at compile time)
+        static_assert(std::is_trivially_destructible_v<T>, "Commands must be trivially destructible");
+        static_assert(std::is_trivially_copyable_v<T>, "Commands must be trivially copyable");
+        static_assert(alignof(T) <= COMMAND_ALIGN, "Commands must not need more alignment than the command stream");
         //sanity check if the state is correct
         GLGE_DEBUG_ASSERT("Adding a new command to a command buffer that is marked as recorded", m_recorded);
-        //add the command to the back of the command buffer
-        m_commands.emplace_back();
-        m_commands.back().template emplace<T>(std::forward<Args>(args) ...);
+
+        //compute the size of the command, everything is kept aligned
+        uint64_t cmdSize = alignSize(sizeof(T));
+        uint64_t size = alignSize(sizeof(CommandHeader)) + cmdSize + alignSize(extraSize);
+        //bump the stream
+        uint8_t* data = grow(size);
+        //write the header
+        new (data) CommandHeader{(uint32_t)size, T::TYPE};
+        data += alignSize(sizeof(CommandHeader));
+        //create the command in place
+        new (data) T(std::forward<Args>(args) ...);
+        //copy the extra data behind the command
+        if (extraSize) {memcpy(data + cmdSize, extra, extraSize);}
+        //one more command
+        ++m_count;
     }
 
+    /**
+     * @brief Get the amount of recorded commands
+     * 
+     * @return uint64_t the amount of commands in the command stream
+     */
+    inline uint64_t getCommandCount() const noexcept {return m_count;}
+
+    /**
+     * @brief Get the size of the command stream
+     * 
+     * @return uint64_t the size of all recorded commands in bytes
+     */
+    inline uint64_t getStreamSize() const noexcept {return m_size;}
+
+    /**
+     * @brief sort the recorded draws to reduce state changes
+     * 
+     * Each material bind together with the draws that follow it and each indirect draw form a unit. Units between two other 
+     * commands are radix sorted by a 64 bit key of (render target, shader, material, vertex page, index page). 
+     * The sort is stable, so units with the same key keep their recorded order. Indirect draws to a different render 
+     * target start a new run, so draws are never moved across a change of the render target. 
+     */
+    void sortDraws() noexcept;
+
+    /**
+     * @brief copy all commands of another command buffer to the end of this one
+     * 
+     * @param other the command buffer to copy the commands from
+     */
+    void append(const CommandBuffer& other) noexcept;
+
+    /**
+     * @brief rewrite the recorded commands to remove and merge redundant commands
+     * 
+     * - a material bind of the material that is already bound is removed
+     * - consecutive draws of render meshes with the same material and geometry pages are merged into a single multi draw
+     * - consecutive memory barriers are merged into one that waits for all of their bits
+     * - a clear that is directly overwritten by a clear of the same attachment is removed
+     */
+    void optimize() noexcept;
+
+    /**
+     * @brief insert the memory barriers the recorded commands need
+     * 
+     * The buffers each compute object writes and the buffers and textures each compute object and material reads are tracked. 
+     * A barrier with only the needed bits is inserted in front of a command that accesses data an earlier command wrote 
+     * and that no barrier made visible yet. The commands are played every frame, so writes at the end are seen by the start. 
+     * Custom commands may access anything, so all pending writes are made visible before them. 
+     */
+    void insertBarriers() noexcept;
+
+    /**
+     * @brief Get the amount of memory barriers the last hazard tracking inserted
+     * 
+     * @return uint64_t the amount of inserted barriers
+     */
+    inline uint64_t getInsertedBarriers() const noexcept {return m_inserted;}
+
+    /**
+     * @brief Get the amount of commands the last optimization removed
+     * 
+     * @return uint64_t the amount of removed commands
+     */
+    inline uint64_t getRemovedCommands() const noexcept {return m_removed;}
+
+    /**
+     * @brief Get the amount of draw commands the last optimization merged into multi draws
+     * 
+     * @return uint64_t the amount of merged draw commands
+     */
+    inline uint64_t getMergedCommands() const noexcept {return m_merged;}
+
     /**
      * @brief mark this command buffer as recorded
      */
@@ -80,9 +197,82 @@ public:
 protected:
 
     /**
-     * @brief store all commands
+     * @brief round a size up to the alignment of the command stream
+     * 
+     * @param size the size to align
+     * @return uint64_t the aligned size
+     */
+    inline static constexpr uint64_t alignSize(uint64_t size) noexcept
+    {return ((size + COMMAND_ALIGN - 1) / COMMAND_ALIGN) * COMMAND_ALIGN;}
+
+    /**
+     * @brief add space to the end of the command stream
+     * 
+     * @param size the amount of bytes to add (must be aligned)
+     * @return uint8_t* a pointer to the new space
+     */
+    uint8_t* grow(uint64_t size) noexcept;
+
+    /**
+     * @brief store the command stream
+     * 
+     * The stream is stored as 64 bit words, so every command in it is aligned. 
+     */
+    std::vector<uint64_t> m_stream;
+    /**
+     * @brief store the amount of bytes of the stream that are used
+     */
+    uint64_t m_size = 0;
+    /**
+     * @brief store the amount of recorded commands
+     */
+    uint64_t m_count = 0;
+
+    /**
+     * @brief store the amount of memory barriers the last hazard tracking inserted
+     */
+    uint64_t m_inserted = 0;
+    /**
+     * @brief store the amount of commands the last optimization removed
+     */
+    uint64_t m_removed = 0;
+    /**
+     * @brief store the amount of draw commands the last optimization merged
+     */
+    uint64_t m_merged = 0;
+
+    /**
+     * @brief store a unit of commands that is moved as a whole while sorting
+     */
+    struct SortUnit {
+        //the sort key of the unit
+        uint64_t key;
+        //the offset of the first command of the unit in the stream in bytes
+        uint64_t offset;
+        //the size of all commands of the unit in bytes
+        uint64_t size;
+    };
+
+    /**
+     * @brief copy a run of units to the sorted stream
+     * 
+     * @param sort true : sort the units by their keys first | false : keep the recorded order
+     * @param out the offset in the sorted stream to copy to, it is advanced by the copied size
+     */
+    void flushSortRun(bool sort, uint64_t& out) noexcept;
+
+    /**
+     * @brief store the stream the rewritten commands are written to, it is kept to not allocate each time
+     */
+    std::vector<uint64_t> m_sortStream;
+    /**
+     * @brief store the units of the current run while sorting
+     */
+    std::vector<SortUnit> m_sortUnits;
+    /**
+     * @brief store the temporary units for the radix sort
      */
-    std::vector<CommandContainer> m_commands;
+    std::vector<SortUnit> m_sortTemp;
 
 };
 
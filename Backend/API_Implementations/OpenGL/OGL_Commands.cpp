@@ -44,6 +44,10 @@
 //add framebuffers
 #include "../../../Frontend/Framebuffer.h"
 #include "OGL_Framebuffer.h"
+//add the state cache to skip redundant state changes
+#include "OGL_StateCache.h"
+//add the staging ring for the indirect draws of merged draws
+#include "OGL_StagingRing.h"
 
 static GLenum getType(VertexElementDataType type) noexcept
 {
@@ -234,30 +238,57 @@ static GLenum __getCompareOp(DepthTestOperator cmp) noexcept {
     }
 }
 
-void GLGE::Graphic::Backend::OGL::Command_Custom::execute() noexcept
+void GLGE::Graphic::Backend::OGL::Command_Custom::execute() const noexcept
 {
     //just run the function
     (*func)(userData);
+    //the function may change any OpenGL state
+    StateCache::invalidate();
 }
 
-void GLGE::Graphic::Backend::OGL::Command_Clear::execute() noexcept
+void GLGE::Graphic::Backend::OGL::Command_Clear::execute() const noexcept
 {
     //just run the clear command
-    glClearNamedFramebufferfv(fbuff, buffType, buffId, &r);
+    glClearNamedFramebufferfv(fbuff->getFBO(), buffType, buffId, &r);
+}
+
+/**
+ * @brief attach the vertex and index buffers of specific memory arena pages to the VAO of a material
+ * 
+ * @param material the material to attach the buffers to
+ * @param vertexPage the page of the vertex memory arena to draw from
+ * @param indexPage the page of the index memory arena to draw from
+ */
+static void __bindGeometry(GLGE::Graphic::Backend::OGL::Material* material, uint32_t vertexPage, uint32_t indexPage) noexcept {
+    //get the instance that owns the memory arenas
+    GLGE::Graphic::Backend::API::Instance* instance = GLGE::Graphic::Backend::INSTANCE.getInstance();
+    //bind the vertex buffer of the page, consecutive draws from the same page keep the attachment
+    GLGE::Graphic::Backend::OGL::StateCache::vertexArrayVertexBuffer(material->getVAO(), 
+                                                                     ((GLGE::Graphic::Backend::OGL::Buffer*)instance->getVertexBuffer()->getPageBuffer(vertexPage))->getBuffer(),
+                                                                     material->getMaterial()->getVertexLayout().getVertexSize());
+    //bind the index buffer of the page
+    GLGE::Graphic::Backend::OGL::StateCache::vertexArrayElementBuffer(material->getVAO(), 
+                                                                      ((GLGE::Graphic::Backend::OGL::Buffer*)instance->getIndexBuffer()->getPageBuffer(indexPage))->getBuffer());
+}
+
+static void __bindCycleBuffer(GLenum target, uint32_t idx, const ::Buffer* buffer) noexcept {
+    //get the GPU buffer that is currently consumed
+    GLGE::Graphic::Backend::OGL::CycleBufferBackend* backend = ((GLGE::Graphic::Backend::API::CycleBuffer*)buffer->getBackend())
+                                                                ->getCurrentGPUBackend<GLGE::Graphic::Backend::OGL::CycleBufferBackend>();
+    //pooled buffers are only a slice of a larger buffer, so bind just their range
+    if (backend->isPooled()) {
+        GLGE::Graphic::Backend::OGL::StateCache::bindBufferRange(target, idx, backend->getBuffer(), backend->getOffset(), backend->getSize());
+    } else {
+        GLGE::Graphic::Backend::OGL::StateCache::bindBufferBase(target, idx, backend->getBuffer());
+    }
 }
 
 static void __bindMaterial(::Material* mat, GLGE::Graphic::Backend::OGL::Material* material) noexcept {
     //check if the material's VAO is valid
     if (material->getVAO() == 0) {
         //if not, create the new VAO
+        //the vertex and index buffers are attached per draw, as they depend on the page the mesh lives in
         glCreateVertexArrays(1, &material->getVAO());
-        glVertexArrayVertexBuffer(material->getVAO(), 0, 
-                                  ((GLGE::Graphic::Backend::OGL::Buffer*)GLGE::Graphic::Backend::INSTANCE.getInstance()->getVertexBuffer()
-                                    ->getBuffer())->getBuffer(),
-                                  0, material->getMaterial()->getVertexLayout().getVertexSize());
-        //bind the index buffer
-        glVertexArrayElementBuffer(material->getVAO(), ((GLGE::Graphic::Backend::OGL::Buffer*)GLGE::Graphic::Backend::INSTANCE.getInstance()
-            ->getIndexBuffer()->getBuffer())->getBuffer());
         //iterate over all elements of the vertex layout
         for (size_t i = 0; i < VERTEX_ELEMENT_TYPE_COUNT; ++i) {
             //get the informatin about the current element
@@ -279,31 +310,24 @@ static void __bindMaterial(::Material* mat, GLGE::Graphic::Backend::OGL::Materia
 
     //get the frontend material settings
     MaterialSettings settings = material->getMaterial()->getSettings();
+    //all state goes through the state cache, so state the last draw already set is skipped
     //set the depth test state correctly
-    if (settings & MATERIAL_SETTING_ENABLE_DEPTH_TEST) {
-        glEnable(GL_DEPTH_TEST);
-    } else {
-        glDisable(GL_DEPTH_TEST);
-    }
+    GLGE::Graphic::Backend::OGL::StateCache::setDepthTest(settings & MATERIAL_SETTING_ENABLE_DEPTH_TEST);
     //set the depth write state correctly
-    glDepthMask((settings & MATERIAL_SETTING_ENABLE_DEPTH_WRITE) ? GL_TRUE : GL_FALSE);
+    GLGE::Graphic::Backend::OGL::StateCache::setDepthMask(settings & MATERIAL_SETTING_ENABLE_DEPTH_WRITE);
     //set the depth test function correctly
-    glDepthFunc(__getCompareOp(material->getMaterial()->getDepthTestOperator()));
+    GLGE::Graphic::Backend::OGL::StateCache::setDepthFunc(__getCompareOp(material->getMaterial()->getDepthTestOperator()));
     //set backface culling
-    if (settings & MATERIAL_SETTING_CULL_BACK_FACE) {
-        glEnable(GL_CULL_FACE);
-    } else {
-        glDisable(GL_CULL_FACE);
-    }
+    GLGE::Graphic::Backend::OGL::StateCache::setCullFace(settings & MATERIAL_SETTING_CULL_BACK_FACE);
 
     //bind the VAO
-    glBindVertexArray(material->getVAO());
+    GLGE::Graphic::Backend::OGL::StateCache::bindVertexArray(material->getVAO());
     //bind the shader
-    glUseProgram(((GLGE::Graphic::Backend::OGL::Shader*)mat->getShader()->getBackend())->getProgram());
+    GLGE::Graphic::Backend::OGL::StateCache::useProgram(((GLGE::Graphic::Backend::OGL::Shader*)mat->getShader()->getBackend())->getProgram());
     //iterate over all textures of the material
     for (uint8_t i = 0; i < mat->getUsedTextureCount(); ++i) {
         //bind the texture to the current unit
-        glBindTextureUnit(i, ((GLGE::Graphic::Backend::OGL::Texture*)((::Texture*) mat->getUsedTextures()[i])->getBackend())->getTexture());
+        GLGE::Graphic::Backend::OGL::StateCache::bindTextureUnit(i, ((GLGE::Graphic::Backend::OGL::Texture*)((::Texture*) mat->getUsedTextures()[i])->getBackend())->getTexture());
     }
     //store how many buffers of a specific type are bound
     uint8_t uboCount = 0;
@@ -319,21 +343,15 @@ static void __bindMaterial(::Material* mat, GLGE::Graphic::Backend::OGL::Materia
         //bind the correct buffer type
         if (mat->getUsedBuffers()[i]->getType() == GLGE_BUFFER_TYPE_UNIFORM) {
             //handle the buffer as a uniform buffer
-            glBindBufferBase(GL_UNIFORM_BUFFER, uboCount++, 
-                ((GLGE::Graphic::Backend::API::CycleBuffer*)mat->getUsedBuffers()[i]->getBackend())
-                    ->getCurrentGPUBackend<GLGE::Graphic::Backend::OGL::CycleBufferBackend>()
-                    ->getBuffer());
+            __bindCycleBuffer(GL_UNIFORM_BUFFER, uboCount++, mat->getUsedBuffers()[i]);
         } else {
             //handle the buffer as a shader storage buffer
-            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, ssboCount++, 
-                ((GLGE::Graphic::Backend::API::CycleBuffer*)mat->getUsedBuffers()[i]->getBackend())
-                    ->getCurrentGPUBackend<GLGE::Graphic::Backend::OGL::CycleBufferBackend>()
-                    ->getBuffer());
+            __bindCycleBuffer(GL_SHADER_STORAGE_BUFFER, ssboCount++, mat->getUsedBuffers()[i]);
         }
     }
 }
 
-void GLGE::Graphic::Backend::OGL::Command_BindMaterial::execute() noexcept
+void GLGE::Graphic::Backend::OGL::Command_BindMaterial::execute() const noexcept
 {
     //get the frontend material
     ::Material* mat = material->getMaterial();
@@ -342,18 +360,57 @@ void GLGE::Graphic::Backend::OGL::Command_BindMaterial::execute() noexcept
     __bindMaterial(mat, material);
 }
 
-void GLGE::Graphic::Backend::OGL::Command_DrawMesh::execute() noexcept
+void GLGE::Graphic::Backend::OGL::Command_DrawMesh::execute() const noexcept
 {
+    //attach the pages the mesh lives in
+    __bindGeometry(material, rMesh->getVertexPointer().page, rMesh->getIndexPointer().page);
     //run the draw command
     glDrawElementsBaseVertex(GL_TRIANGLES, rMesh->getIndexPointer().size / sizeof(index_t), GL_UNSIGNED_INT, (void*)rMesh->getIndexPointer().startIdx, 
                              rMesh->getVertexPointer().startIdx/rMesh->getRenderMesh()->getMesh()->getVertexLayout().getVertexSize());
 }
 
+void GLGE::Graphic::Backend::OGL::Command_MultiDrawMeshes::execute() const noexcept
+{
+    //get the meshes to draw
+    API::RenderMesh* const* meshes = getMeshes();
+    //a single draw can only read from one vertex and one index page
+    uint32_t vertexPage = meshes[0]->getVertexPointer().page;
+    uint32_t indexPage = meshes[0]->getIndexPointer().page;
+    bool samePages = true;
+    for (uint32_t i = 1; i < count; ++i) 
+    {samePages &= (meshes[i]->getVertexPointer().page == vertexPage) && (meshes[i]->getIndexPointer().page == indexPage);}
+
+    //stage the indirect draw structures (20 bytes each)
+    StagingRing::Allocation alloc = samePages ? StagingRing::allocate(count * 5 * sizeof(uint32_t)) : StagingRing::Allocation{};
+    if (!alloc.mapped) {
+        //the meshes were moved to different pages or the ring is full, so draw the meshes one by one
+        for (uint32_t i = 0; i < count; ++i) {Command_DrawMesh(meshes[i], material).execute();}
+        return;
+    }
+    //fill in the draw of each mesh
+    uint32_t* draws = (uint32_t*)alloc.mapped;
+    for (uint32_t i = 0; i < count; ++i) {
+        const API::RenderMesh* rMesh = meshes[i];
+        //index count, instance count, first index, base vertex, base instance
+        draws[i*5 + 0] = rMesh->getIndexPointer().size / sizeof(index_t);
+        draws[i*5 + 1] = 1;
+        draws[i*5 + 2] = rMesh->getIndexPointer().startIdx / sizeof(index_t);
+        draws[i*5 + 3] = rMesh->getVertexPointer().startIdx / rMesh->getRenderMesh()->getMesh()->getVertexLayout().getVertexSize();
+        draws[i*5 + 4] = 0;
+    }
+
+    //attach the pages the meshes live in
+    __bindGeometry(material, vertexPage, indexPage);
+    //draw all meshes at once from the staging ring
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, alloc.buffer);
+    glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)alloc.offset, count, 0);
+}
+
 static void __dispatchCompute(Compute* cmp, uint32_t x, uint32_t y, uint32_t z) noexcept {
     //bind all the textures
     for (uint8_t i = 0; i < cmp->getTextureCount(); ++i) {
         //bind the texture
-        glBindTextureUnit(i, ((GLGE::Graphic::Backend::OGL::Texture*)((::Texture*)cmp->getTexture(i))->getBackend())->getTexture());
+        GLGE::Graphic::Backend::OGL::StateCache::bindTextureUnit(i, ((GLGE::Graphic::Backend::OGL::Texture*)((::Texture*)cmp->getTexture(i))->getBackend())->getTexture());
     }
     //bind all the buffers
     //store how many buffers of a specific type are bound
@@ -370,25 +427,19 @@ static void __dispatchCompute(Compute* cmp, uint32_t x, uint32_t y, uint32_t z)
         //bind the correct buffer type
         if (cmp->getBuffer(i)->getType() == GLGE_BUFFER_TYPE_UNIFORM) {
             //handle the buffer as a uniform buffer
-            glBindBufferBase(GL_UNIFORM_BUFFER, uboCount++, 
-                ((GLGE::Graphic::Backend::API::CycleBuffer*)cmp->getBuffer(i)->getBackend())
-                    ->getCurrentGPUBackend<GLGE::Graphic::Backend::OGL::CycleBufferBackend>()
-                    ->getBuffer());
+            __bindCycleBuffer(GL_UNIFORM_BUFFER, uboCount++, cmp->getBuffer(i));
         } else {
             //handle the buffer as a shader storage buffer
-            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, ssboCount++, 
-                ((GLGE::Graphic::Backend::API::CycleBuffer*)cmp->getBuffer(i)->getBackend())
-                    ->getCurrentGPUBackend<GLGE::Graphic::Backend::OGL::CycleBufferBackend>()
-                    ->getBuffer());
+            __bindCycleBuffer(GL_SHADER_STORAGE_BUFFER, ssboCount++, cmp->getBuffer(i));
         }
     }
     //bind the actual shader
-    glUseProgram(((GLGE::Graphic::Backend::OGL::Shader*)cmp->getShader()->getBackend())->getProgram());
+    GLGE::Graphic::Backend::OGL::StateCache::useProgram(((GLGE::Graphic::Backend::OGL::Shader*)cmp->getShader()->getBackend())->getProgram());
     //dispatch the compute shader
     glDispatchCompute(x,y,z);
 }
 
-void GLGE::Graphic::Backend::OGL::Command_DispatchCompute::execute() noexcept
+void GLGE::Graphic::Backend::OGL::Command_DispatchCompute::execute() const noexcept
 {
     //extract the compute object
     Compute* cmp = (Compute*)compute;
@@ -397,17 +448,49 @@ void GLGE::Graphic::Backend::OGL::Command_DispatchCompute::execute() noexcept
     __dispatchCompute(cmp, x, y, z);
 }
 
-void GLGE::Graphic::Backend::OGL::Command_MemoryBarrier::execute() noexcept
+void GLGE::Graphic::Backend::OGL::Command_MemoryBarrier::execute() const noexcept
 {
-    //just run a memory barrier
-    glMemoryBarrier(GL_ALL_BARRIER_BITS);
+    //just run the memory barrier
+    glMemoryBarrier(bits);
 }
 
-void GLGE::Graphic::Backend::OGL::Command_DrawMeshesIndirect::execute() noexcept
+void GLGE::Graphic::Backend::OGL::Command_UploadBatches::execute() const noexcept
 {
+    //the buffers of an earlier playback are not needed anymore
+    if (upload->buffers.size()) 
+    {glDeleteBuffers(upload->buffers.size(), upload->buffers.data());}
+    upload->buffers.clear();
+    //an empty scene needs no buffers
+    if (upload->counts.empty()) {return;}
+    //create a buffer for each batch and the shared draw buffer
+    upload->buffers.resize(upload->counts.size() + 1);
+    glCreateBuffers(upload->buffers.size(), upload->buffers.data());
+
+    //store the most meshes in a single batch
+    //this is used to set up the draw buffer correctly
+    size_t maxMeshCount = 0;
+    //upload the data of all batches
+    uint64_t start = 0;
+    for (size_t i = 0; i < upload->counts.size(); ++i) {
+        glNamedBufferStorage(upload->buffers[i], upload->counts[i]*sizeof(uint64_t), upload->pairs.data() + start, 0);
+        start += upload->counts[i];
+        maxMeshCount = (maxMeshCount > upload->counts[i]) ? maxMeshCount : upload->counts[i];
+    }
+
+    //allocate enough data for all draw elements
+    //(it is important to know that one indirect draw structure is 20 bytes)
+    glNamedBufferStorage(upload->buffers.back(), maxMeshCount*20, nullptr, 0);
+}
+
+void GLGE::Graphic::Backend::OGL::Command_DrawMeshesIndirect::execute() const noexcept
+{
+    //get the buffers of the batch
+    uint64_t meshCount = batches->counts[batch];
+    uint32_t batchBuffer = batches->buffers[batch];
+    uint32_t drawBuffer = batches->buffers.back();
+
     //extract the camera
     Camera* cam = (Camera*)camera;
-    uint32_t camBuff = ((API::CycleBuffer*)cam->getBuffer()->getBackend())->getCurrentGPUBackend<OGL::CycleBufferBackend>()->getBuffer();
     //adjust the viewport for the framebuffer
     uivec2 size(0,0);
     switch (cam->getTarget().type)
@@ -447,18 +530,23 @@ void GLGE::Graphic::Backend::OGL::Command_DrawMeshesIndirect::execute() noexcept
     //it is assumed that the batch size of the compute shader is 64
     uint64_t invoke = (uint64_t)std::ceil(meshCount / 64.);
     //iterate over all compute shader to run
-    for (size_t i = 0; i < shaders.size(); ++i) {
+    void* const* shaders = getShaders();
+    for (uint32_t i = 0; i < shaderCount; ++i) {
         //bind the camera buffer
-        glBindBufferBase(GL_UNIFORM_BUFFER, 0, camBuff);
+        __bindCycleBuffer(GL_UNIFORM_BUFFER, 0, cam->getBuffer());
         //bind the buffers at the pre-determined indices
-        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, batchBuffer);
-        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, drawBuffer);
+        StateCache::bindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, batchBuffer);
+        StateCache::bindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, drawBuffer);
         //run the compute shader
         __dispatchCompute((Compute*)shaders[i], invoke, 1, 1);
     }
+    //the compute shaders fill the draw buffer, so the draw must wait for their writes
+    if (shaderCount) {glMemoryBarrier(GL_COMMAND_BARRIER_BIT);}
 
     //bind the material
     __bindMaterial(material->getMaterial(), material);
+    //attach the pages all meshes of the batch live in
+    __bindGeometry(material, vertexPage, indexPage);
 
     //bind the indirect buffer
     glBindBuffer(GL_DRAW_INDIRECT_BUFFER, drawBuffer);
@@ -467,8 +555,8 @@ void GLGE::Graphic::Backend::OGL::Command_DrawMeshesIndirect::execute() noexcept
     glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, 0, meshCount, 0);
 }
 
-void GLGE::Graphic::Backend::OGL::Command_Blit::execute() noexcept {
+void GLGE::Graphic::Backend::OGL::Command_Blit::execute() const noexcept {
     //execute the actual OpenGL blit command
-    glBlitNamedFramebuffer(from, to, from_offset.x, from_offset.y, from_target.x, from_target.y, 
+    glBlitNamedFramebuffer(from ? from->getFBO() : 0, to ? to->getFBO() : 0, from_offset.x, from_offset.y, from_target.x, from_target.y, 
                            to_offset.x, to_offset.y, to_target.x, to_target.y, mask, filter);
 }
\ No newline at end of file
@@ -39,115 +39,76 @@ namespace GLGE::Graphic::Backend::OGL
 
 //add materials
 class Material;
+//add framebuffers
+class Framebuffer;
 
 /**
- * @brief define what an OpenGL command is
+ * @brief store the batches of a scene that are uploaded to the GPU when the command buffer is played
  */
-struct Command
+struct BatchUpload
 {
-    /**
-     * @brief Destroy the Command
-     */
-    virtual ~Command() noexcept = default;
-
-    /**
-     * @brief run the actual OpenGL command
-     */
-    virtual void execute() noexcept = 0;
-
-//define some limits for a command
+    //store the object - mesh pairs of all batches, one batch after another
+    std::vector<uint64_t> pairs;
+    //store the amount of pairs in each batch
+    std::vector<uint64_t> counts;
+    //store the OpenGL buffers, one for each batch and the shared draw buffer last (created by the upload command)
+    std::vector<uint32_t> buffers;
+};
 
 /**
- * @brief define the maximum amount of bytes available for parameter storage
+ * @brief define the type of each command
+ * 
+ * The type is stored in front of the command in the command stream and selects how the command is executed. 
  */
-static constexpr size_t MAX_COMMAND_SIZE = 64;
+enum class CommandType : uint8_t {
+    //a call to a custom function
+    COMMAND_CUSTOM = 0,
+    //a clear of a framebuffer attachment
+    COMMAND_CLEAR,
+    //a bind of a material
+    COMMAND_BIND_MATERIAL,
+    //a draw of a single render mesh
+    COMMAND_DRAW_MESH,
+    //a dispatch of a compute shader
+    COMMAND_DISPATCH_COMPUTE,
+    //a memory barrier
+    COMMAND_MEMORY_BARRIER,
+    //an upload of the batches of a scene
+    COMMAND_UPLOAD_BATCHES,
+    //an indirect draw of a batch of meshes
+    COMMAND_DRAW_MESHES_INDIRECT,
+    //a single draw of multiple render meshes that share a material
+    COMMAND_MULTI_DRAW_MESHES,
+    //a copy from one render target to another
+    COMMAND_BLIT
+};
+
 /**
- * @brief define what the maximum alignment is
+ * @brief store what is in front of each command in the command stream
  */
-static constexpr size_t MAX_COMMAND_ALIGN = alignof(std::max_align_t);
+struct CommandHeader
+{
+    //the size of the command including this header and all extra data in bytes
+    uint32_t size;
+    //the type of the command
+    CommandType type;
 };
 
 /**
- * @brief define what an actual command is
+ * @brief define the alignment of all commands in the command stream
  * 
- * Just a base class for all commands to implement
+ * Commands are plain structures without any virtual functions that are copied into the stream, so they must not need more alignment. 
  */
-struct CommandContainer
-{
-    /**
-     * @brief store the command data
-     */
-    alignas(Command::MAX_COMMAND_ALIGN) std::byte storage[Command::MAX_COMMAND_SIZE];
-    /**
-     * @brief encapsulate a base command (do not inherit from it)
-     * 
-     * This should point to the start of storage only if the element exists
-     */
-    Command* ptr = nullptr;
-
-    /**
-     * @brief make this an actual command
-     * 
-     * @tparam T the type of command to create
-     * @tparam Args the type of arguments to create
-     * @param args the actual templates
-     */
-    template <typename T, typename ...Args>
-    void emplace(Args&& ...args) {
-        //sanity check the inputs (static to do at compile time)
-        static_assert(sizeof(T) <= Command::MAX_COMMAND_SIZE, "CommandContainer too large");
-        static_assert(std::is_base_of<Command, T>().value, "T must derive from command");
-        //create the actual commands
-        ptr = new (storage) T(std::forward<Args>(args)...);
-    }
-
-    /**
-     * @brief run the actual command
-     */
-    inline void execute() noexcept {ptr->execute();}
-
-    /**
-     * @brief clean up the command
-     */
-    void destroy() noexcept {
-        if (ptr) {
-            ptr->~Command();
-            ptr = nullptr;
-        }
-    }
-
-    /**
-     * @brief Destroy the CommandContainer
-     */
-    ~CommandContainer() {destroy();}
-
-    /**
-     * @brief Construct a new Command Container by moving from another one
-     * 
-     * @param other the container to move from
-     */
-    CommandContainer(CommandContainer&& other) noexcept {
-        if (other.ptr) {
-            //copy the storage over
-            memcpy(storage, other.storage, sizeof(storage));
-            ptr = (GLGE::Graphic::Backend::OGL::Command*)storage;
-            //nullify the other pointer to stop deletion
-            other.ptr = nullptr;
-        }
-    }
-
-    //explicitly delete the copy constructor
-    CommandContainer(CommandContainer&) = delete;
-
-    //simple constructor
-    CommandContainer() = default;
-};
+inline constexpr size_t COMMAND_ALIGN = sizeof(uint64_t);
 
 /**
  * @brief implement a custom command
  */
-struct Command_Custom final : public Command
+struct Command_Custom
 {
+    //the type of the command in the command stream
+    static constexpr CommandType TYPE = CommandType::COMMAND_CUSTOM;
+
     /**
      * @brief Construct a new custom command
      * 
@@ -164,14 +125,17 @@ struct Command_Custom final : public Command
     void* userData;
 
     //run the custom command
-    virtual void execute() noexcept override;
+    void execute() const noexcept;
 };
 
 /**
  * @brief clear command for OpenGL implementation
  */
-struct Command_Clear final : public Command
+struct Command_Clear
 {
+    //the type of the command in the command stream
+    static constexpr CommandType TYPE = CommandType::COMMAND_CLEAR;
+
     /**
      * @brief Construct a new clear command
      * 
@@ -179,31 +143,34 @@ struct Command_Clear final : public Command
      * @param _g the green part of the color to clear with
      * @param _b the blue part of the color to clear with
      * @param _a the alpha part of the color to clear with
-     * @param _fbuff the name of the framebuffer to clear
+     * @param _fbuff the framebuffer to clear (the framebuffer object is queried when the command is executed, as it may be re-created)
      * @param _buffType the type of the buffer attachment to clear
      * @param _buffId the ID of the buffer to clear
      */
-    Command_Clear(float _r, float _g, float _b, float _a, uint32_t _fbuff, uint32_t _buffType, uint32_t _buffId) noexcept
+    Command_Clear(float _r, float _g, float _b, float _a, OGL::Framebuffer* _fbuff, uint32_t _buffType, uint32_t _buffId) noexcept
      : r(_r), g(_g), b(_b), a(_a), fbuff(_fbuff), buffType(_buffType), buffId(_buffId)
     {}
 
     //store the color to clear
     float r = 0, g = 0, b = 0, a = 1;
-    //store the framebuffer object to clear
-    uint32_t fbuff = 0;
+    //store the framebuffer to clear
+    OGL::Framebuffer* fbuff = nullptr;
     //store the type of buffer to clear
     uint32_t buffType = 0;
     uint32_t buffId = 0;
 
     //run the actual OpenGL command
-    virtual void execute() noexcept override;
+    void execute() const noexcept;
 };
 
 /**
  * @brief a command to bind a material in OpenGL
  */
-struct Command_BindMaterial final : public Command
+struct Command_BindMaterial
 {
+    //the type of the command in the command stream
+    static constexpr CommandType TYPE = CommandType::COMMAND_BIND_MATERIAL;
+
     /**
      * @brief Construct a new Bind Material command
      * 
@@ -217,35 +184,85 @@ struct Command_BindMaterial final : public Command
     OGL::Material* material;
 
     //run the actual bind command
-    virtual void execute() noexcept override;
+    void execute() const noexcept;
 };
 
 /**
  * @brief a command that is used to draw a simple mesh
  */
-struct Command_DrawMesh final : public Command
+struct Command_DrawMesh
 {
+    //the type of the command in the command stream
+    static constexpr CommandType TYPE = CommandType::COMMAND_DRAW_MESH;
+
     /**
      * @brief Construct a new Draw Mesh command
      * 
      * @param _rMesh a pointer to the render mesh to draw
+     * @param _material the material the mesh is drawn with (must already be bound)
      */
-    Command_DrawMesh(API::RenderMesh* _rMesh)
-     : rMesh(_rMesh)
+    Command_DrawMesh(API::RenderMesh* _rMesh, OGL::Material* _material)
+     : rMesh(_rMesh), material(_material)
     {}
 
     //store a pointer to the render mesh to draw
     API::RenderMesh* rMesh;
+    //store the material to bind the pages of the mesh to
+    OGL::Material* material;
+
+    //run the actual drawing command
+    void execute() const noexcept;
+};
+
+/**
+ * @brief a command that draws multiple render meshes of the same material with a single draw call
+ * 
+ * It is created by the command optimizer from consecutive draw mesh commands. 
+ */
+struct Command_MultiDrawMeshes
+{
+    //the type of the command in the command stream
+    static constexpr CommandType TYPE = CommandType::COMMAND_MULTI_DRAW_MESHES;
+
+    /**
+     * @brief Construct a new Multi Draw Meshes command
+     * 
+     * The render meshes to draw are stored directly behind the command in the command stream. 
+     * 
+     * @param _material the material the meshes are drawn with (must already be bound)
+     * @param _count the amount of render meshes to draw
+     */
+    Command_MultiDrawMeshes(OGL::Material* _material, uint32_t _count)
+     : material(_material), count(_count)
+    {}
+
+    //store the material to bind the pages of the meshes to
+    OGL::Material* material;
+    //store the amount of render meshes to draw
+    uint32_t count;
+
+    /**
+     * @brief Get the render meshes to draw
+     * 
+     * @return API::RenderMesh* const* a pointer to the render meshes stored behind the command
+     */
+    inline API::RenderMesh* const* getMeshes() const noexcept {return (API::RenderMesh* const*)(this + 1);}
 
     //run the actual drawing command
-    virtual void execute() noexcept override;
+    void execute() const noexcept;
 };
 
+//the meshes directly follow the command, so its size must keep them aligned
+static_assert((sizeof(Command_MultiDrawMeshes) % COMMAND_ALIGN) == 0, "Command_MultiDrawMeshes must keep its meshes aligned");
+
 /**
  * @brief store a command that dispatches a compute shader
  */
-struct Command_DispatchCompute final : public Command
+struct Command_DispatchCompute
 {
+    //the type of the command in the command stream
+    static constexpr CommandType TYPE = CommandType::COMMAND_DISPATCH_COMPUTE;
+
     /**
      * @brief Construct a new Dispatch compute command
      * 
@@ -265,91 +282,149 @@ struct Command_DispatchCompute final : public Command
     uint32_t x, y, z;
 
     //run the actual dispatch and data binding
-    virtual void execute() noexcept override;
+    void execute() const noexcept;
 };
 
 /**
  * @brief store a command that runs a memory barrier
  */
-struct Command_MemoryBarrier final : public Command
+struct Command_MemoryBarrier
 {
+    //the type of the command in the command stream
+    static constexpr CommandType TYPE = CommandType::COMMAND_MEMORY_BARRIER;
+
     /**
      * @brief Construct a new Memory barrier command
+     * 
+     * @param _bits the OpenGL barrier bits to wait for
      */
-    Command_MemoryBarrier() = default;
+    Command_MemoryBarrier(uint32_t _bits)
+     : bits(_bits)
+    {}
+
+    //store the OpenGL barrier bits
+    uint32_t bits;
 
     //run the actual memory barrier
-    virtual void execute() noexcept override;
+    void execute() const noexcept;
+};
+
+/**
+ * @brief store a command that uploads the batches of a scene to new OpenGL buffers
+ */
+struct Command_UploadBatches
+{
+    //the type of the command in the command stream
+    static constexpr CommandType TYPE = CommandType::COMMAND_UPLOAD_BATCHES;
+
+    /**
+     * @brief Construct a new upload batches command
+     * 
+     * @param _upload the batches to upload, they must stay valid as long as the command exists
+     */
+    Command_UploadBatches(BatchUpload* _upload)
+     : upload(_upload)
+    {}
+
+    //store the batches to upload
+    BatchUpload* upload;
+
+    //run the actual upload
+    void execute() const noexcept;
 };
 
 /**
  * @brief store a command that is used to draw a lot of meshes in parallel
  */
-struct Command_DrawMeshesIndirect final : public Command
+struct Command_DrawMeshesIndirect
 {
+    //the type of the command in the command stream
+    static constexpr CommandType TYPE = CommandType::COMMAND_DRAW_MESHES_INDIRECT;
 
     /**
      * @brief Construct a new draw mesh indirect command
      * 
-     * @param _meshCount the amount of meshes to draw
-     * @param _batchBuffer the OpenGL batch buffer to use for this batch
-     * @param _drawBuffer the OpenGL draw buffer to use for this batch
-     * @param _shaders a list of compute shaders to run before drawing
+     * The compute shaders to run before drawing are stored directly behind the command in the command stream. 
+     * 
+     * @param _camera the camera to draw the batch with
+     * @param _material the material to draw the batch with
+     * @param _batches the uploaded batches of the scene (an upload command must be executed first)
+     * @param _batch the index of the batch to draw
+     * @param _shaderCount the amount of compute shaders to run before drawing
+     * @param _vertexPage the page of the vertex memory arena all meshes of the batch live in
+     * @param _indexPage the page of the index memory arena all meshes of the batch live in
      */
-    Command_DrawMeshesIndirect(void* _camera, OGL::Material* _material, uint64_t _meshCount, uint32_t _batchBuffer, uint32_t _drawBuffer, 
-                               void** shader, uint64_t shaderCount)
-     : camera(_camera), material(_material), meshCount(_meshCount), batchBuffer(_batchBuffer), drawBuffer(_drawBuffer), 
-       shaders(shader, (void**)((uint8_t**)shader + shaderCount))
+    Command_DrawMeshesIndirect(void* _camera, OGL::Material* _material, const BatchUpload* _batches, uint32_t _batch, 
+                               uint32_t _shaderCount, uint32_t _vertexPage = 0, uint32_t _indexPage = 0)
+     : camera(_camera), material(_material), batches(_batches), batch(_batch), 
+       vertexPage(_vertexPage), indexPage(_indexPage), shaderCount(_shaderCount)
     {}
 
     //store the camera for the batch
     void* camera;
     //store the material to use for the batch
     OGL::Material* material;
-    //store the amount of meshes to draw
-    uint64_t meshCount;
-    //store the batch buffer (always mapped to binding = 0)
-    uint32_t batchBuffer;
-    //store the draw buffer (always mapped to binding = 1)
-    uint32_t drawBuffer;
-    //store a list of shaders to execute before drawing
-    std::vector<void*> shaders;
+    //store the uploaded batches the batch belongs to
+    //the batch buffer is always mapped to binding = 0 and the draw buffer to binding = 1
+    const BatchUpload* batches;
+    //store the index of the batch to draw
+    uint32_t batch;
+    //store the vertex page to draw from
+    uint32_t vertexPage;
+    //store the index page to draw from
+    uint32_t indexPage;
+    //store the amount of shaders to execute before drawing
+    uint32_t shaderCount;
+
+    /**
+     * @brief Get the compute shaders to run before drawing
+     * 
+     * @return void* const* a pointer to the frontend compute objects stored behind the command
+     */
+    inline void* const* getShaders() const noexcept {return (void* const*)(this + 1);}
 
     //run the actual draw command
-    virtual void execute() noexcept override;
+    void execute() const noexcept;
 };
 
+//the shaders directly follow the command, so its size must keep them aligned
+static_assert((sizeof(Command_DrawMeshesIndirect) % COMMAND_ALIGN) == 0, "Command_DrawMeshesIndirect must keep its shaders aligned");
+
 /**
  * @brief store a command that is used to copy content from one render target to another
  */
-struct Command_Blit final : public Command {
+struct Command_Blit
+{
+    //the type of the command in the command stream
+    static constexpr CommandType TYPE = CommandType::COMMAND_BLIT;
+
 
     /**
      * @brief Construct a new Blit command
      * 
-     * @param _from the OpenGL target to copy from
+     * @param _from the framebuffer to copy from (nullptr is the window)
      * @param _from_extend the extend of the rectangle to copy from
      * @param _from_offset the offset of the rectangle to copy from
-     * @param _to the OpenGL target to copy to
+     * @param _to the framebuffer to copy to (nullptr is the window)
      * @param _to_extend the extend of the rectangle to copy to
      * @param _to_offset the offset of the rectangle to copy to
      * @param _filter the filtering mode to use for sampling
      * @param _mask the mask of data to copy
      */
-    Command_Blit(uint32_t _from, const uivec2& _from_extend, const uivec2& _from_offset,
-                 uint32_t _to,   const uivec2& _to_extend,   const uivec2& _to_offset, uint32_t _filter, uint32_t _mask)
+    Command_Blit(OGL::Framebuffer* _from, const uivec2& _from_extend, const uivec2& _from_offset,
+                 OGL::Framebuffer* _to,   const uivec2& _to_extend,   const uivec2& _to_offset, uint32_t _filter, uint32_t _mask)
      : from(_from), from_target(_from_offset + _from_extend), from_offset(_from_offset),
        to(_to),     to_target(_from_offset + _to_extend),     to_offset(_to_offset), filter(_filter), mask(_mask)
     {}
 
-    //the buffer to copy from
-    uint32_t from;
+    //the framebuffer to copy from
+    OGL::Framebuffer* from;
     //the extend of the rectangle to copy
     uivec2 from_target;
     //the offset of the rectangle to copy to
     uivec2 from_offset;
-    //the target to copy to
-    uint32_t to;
+    //the framebuffer to copy to
+    OGL::Framebuffer* to;
     //the extend of the rectangle to copy to
     uivec2 to_target;
     //the offset of the rectangle to copy to
@@ -360,7 +435,7 @@ struct Command_Blit final : public Command {
     uint32_t mask;
 
     //run the actual draw command
-    virtual void execute() noexcept override;
+    void execute() const noexcept;
 };
 
 }
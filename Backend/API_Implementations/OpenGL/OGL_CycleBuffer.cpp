@@ -14,6 +14,8 @@
 #include <cstring>
 //add OpenGL
 #include <glad/glad.h>
+//add the instance for the frame timeline
+#include "OGL_Instance.h"
 
 //use the OpenGL namespace
 using namespace GLGE::Graphic::Backend::OGL;
@@ -25,31 +27,41 @@ CycleBufferBackend::CycleBufferBackend(API::CycleBuffer* cycleBuffer, uint8_t id
     queueUpdate();
 }
 
-void CycleBufferBackend::syncCPU(bool force) noexcept
+CycleBufferBackend::~CycleBufferBackend()
 {
-    //if a fence exists, only execute if the fence is signaled
-    if (m_sync && !force) {
-        //get the result - timeout 0 means non-blocking
-        GLenum res = glClientWaitSync((GLsync)m_sync, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
-        //check if the sync failed
-        if ((res == GL_TIMEOUT_EXPIRED) || (res == GL_WAIT_FAILED)) {
-            return;
+    //the backend must not be updated anymore
+    if (m_update.load(std::memory_order_acquire)) {
+        std::unique_lock lock(m_updateMtx);
+        for (size_t i = 0; i < m_updateQueue.size(); ++i) {
+            if (m_updateQueue[i] == this) {
+                m_updateQueue.erase(m_updateQueue.begin() + i);
+                break;
+            }
         }
-        //clean up the fence - does nothing
-        glDeleteSync((GLsync)m_sync);
-        m_sync = nullptr;
     }
+    //give the slice back to the pool
+    BufferPool::release(m_slice);
+    m_cBuff = nullptr;
+}
+
+void CycleBufferBackend::syncCPU(bool force) noexcept
+{
+    //only execute if the GPU finished the last frame that used this buffer
+    if (!force && (m_usedFrame > OGL::Instance::getCompletedFrame())) {return;}
 
     //check if an update is needed
     if (m_version != m_cBuff->getVersion()) {
         //check if the size is up to date
         if (m_size == m_cBuff->getSize()) {
-            //just pass the data
-            memcpy(m_mapped, m_cBuff->getRaw(), m_size);
+            //only copy the regions that changed since the last sync of this backend
+            uploadDirty(m_mapped, m_size);
         } else {
             //else, update the data
             update();
         }
+        //the backend is in sync with the cycle buffer
+        m_dirty.clear();
+        m_fullSync = false;
         //store the new version
         m_version = m_cBuff->getVersion();
     }
@@ -57,37 +69,101 @@ void CycleBufferBackend::syncCPU(bool force) noexcept
 
 void CycleBufferBackend::markInUse() noexcept
 {
-    //delete any previous fence
-    if (m_sync) {
-        glDeleteSync((GLsync)m_sync);
-        m_sync = nullptr;
-    }
-    //create a new fence to mark when the GPU consumed the data
-    m_sync = (void*)glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    //the buffer is consumed by the frame that is recorded now
+    m_usedFrame = OGL::Instance::getCurrentFrame();
 }
 
 void CycleBufferBackend::update() noexcept
 {
-    //first, check if the buffer exists
-    if (!m_buff) {
-        //if not, create it
-        glCreateBuffers(1, &m_buff);
-    }
-    //check if the size is up to date
-    if (m_size != m_cBuff->getSize()) {
-        //store the updated values
-        m_size = m_cBuff->getSize();
-        //store the flags to apply
-        GLenum flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
-        //update the size
-        glNamedBufferStorage(m_buff, m_size, m_cBuff->getRaw(), flags);
-        //map the permanent data
-        m_mapped = glMapNamedBufferRange(m_buff, 0, m_size, flags);
+    //get the size the GPU buffer needs
+    uint64_t size = m_cBuff->getSize();
+
+    //small buffers live in a slice of a pooled buffer
+    if (BufferPool::isPooled(size)) {
+        //check if the current slice can hold the data
+        if (m_slice.size < size) {
+            //a buffer that owns its OpenGL buffer can't switch to the pool
+            if (m_buff && !isPooled()) {glDeleteBuffers(1, &m_buff);}
+            //give the old slice back and get a larger one
+            BufferPool::release(m_slice);
+            m_slice = BufferPool::allocate(size);
+            m_buff = m_slice.buffer;
+            m_mapped = m_slice.mapped;
+            //force the upload of the data
+            m_size = 0;
+        }
+        //check if the size is up to date
+        if (m_size != size) {
+            //store the updated values
+            m_size = size;
+            //upload the data to the slice
+            memcpy(m_mapped, m_cBuff->getRaw(), m_size);
+        }
+    } else {
+        //the buffer is too large for a slice
+        if (isPooled()) {
+            BufferPool::release(m_slice);
+            m_slice = BufferPool::Slice();
+            m_buff = 0;
+            m_mapped = nullptr;
+            m_size = 0;
+        }
+        //first, check if the buffer exists
+        if (!m_buff) {
+            //if not, create it
+            glCreateBuffers(1, &m_buff);
+        }
+        //check if the size is up to date
+        if (m_size != size) {
+            //store the flags to apply
+            GLenum flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            //immutable storage can't be re-sized, so existing data is moved to a new buffer
+            uint32_t oldBuff = 0;
+            void* oldMapped = m_mapped;
+            uint64_t oldSize = m_size;
+            if (oldSize) {
+                oldBuff = m_buff;
+                glCreateBuffers(1, &m_buff);
+            }
+            //store the updated values
+            m_size = size;
+            //create the storage, a new buffer gets its data directly
+            glNamedBufferStorage(m_buff, m_size, oldBuff ? nullptr : m_cBuff->getRaw(), flags);
+            //map the permanent data
+            m_mapped = glMapNamedBufferRange(m_buff, 0, m_size, flags);
+
+            if (oldBuff) {
+                //the data that is kept is already on the GPU
+                uint64_t kept = (oldSize < m_size) ? oldSize : m_size;
+                //changes to the kept data are written to the old buffer first, the copy then moves them along
+                uploadDirty(oldMapped, kept);
+                glCopyNamedBufferSubData(oldBuff, m_buff, 0, 0, kept);
+                //only the new region is uploaded directly
+                memcpy((uint8_t*)m_mapped + kept, (uint8_t*)m_cBuff->getRaw() + kept, m_size - kept);
+                //commands recorded from now on use the new buffer, the old one is deleted once the GPU is done with it
+                glDeleteBuffers(1, &oldBuff);
+            }
+        }
     }
     //update is no longer required
     m_update.store(false, std::memory_order_release);
 }
 
+void CycleBufferBackend::uploadDirty(void* mapped, uint64_t end) noexcept
+{
+    //copy everything if the changes are not tracked
+    if (m_fullSync) {
+        memcpy(mapped, m_cBuff->getRaw(), end);
+        return;
+    }
+    //else, only copy the regions that changed since the last sync
+    for (const API::Buffer::DirtyRange& range : m_dirty) {
+        if (range.start >= end) {break;}
+        memcpy((uint8_t*)mapped + range.start, (uint8_t*)m_cBuff->getRaw() + range.start, 
+               ((range.end > end) ? end : range.end) - range.start);
+    }
+}
+
 void CycleBufferBackend::queueUpdate() noexcept
 {
     //if this is allready updating, stop
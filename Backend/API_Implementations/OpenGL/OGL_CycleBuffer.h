@@ -14,6 +14,8 @@
 
 //add the cycle buffer API
 #include "../API_CycleBuffer.h"
+//add the pool for small buffers
+#include "OGL_BufferPool.h"
 
 //only available for C++
 #if __cplusplus
@@ -45,7 +47,7 @@ public:
     /**
      * @brief Destroy the Cycle Buffer Backend
      */
-    virtual ~CycleBufferBackend() {m_cBuff = nullptr;}
+    virtual ~CycleBufferBackend();
 
     /**
      * @brief sync the GPU and CPU data with the data from the cycle buffer
@@ -63,7 +65,33 @@ public:
     inline uint32_t getBuffer() const noexcept {return m_buff;}
 
     /**
-     * @brief mark that this buffer is now the GPU consumed buffer
+     * @brief Get the offset of the data in the OpenGL buffer
+     * 
+     * @return uint64_t the offset in bytes (only non-zero if the buffer is pooled)
+     */
+    inline uint64_t getOffset() const noexcept {return m_slice.offset;}
+
+    /**
+     * @brief Get the Size of the data in the OpenGL buffer
+     * 
+     * @return uint64_t the size of the data in bytes
+     */
+    inline uint64_t getSize() const noexcept {return m_size;}
+
+    /**
+     * @brief check if the buffer is a slice of a pooled OpenGL buffer
+     * 
+     * Pooled buffers must be bound using `glBindBufferRange`. 
+     * 
+     * @return true : the buffer is a slice of a pooled buffer
+     * @return false : the buffer owns its OpenGL buffer
+     */
+    inline bool isPooled() const noexcept {return m_slice.size != 0;}
+
+    /**
+     * @brief mark that this buffer is used by the GPU in the frame that is recorded now
+     * 
+     * This is called when the buffer becomes the GPU consumed buffer and again when it stops being it. 
      * @warning this should only be called from the main thread during the main graphic update
      */
     virtual void markInUse() noexcept override;
@@ -75,6 +103,14 @@ protected:
      */
     void update() noexcept;
 
+    /**
+     * @brief copy the regions that changed since the last sync to mapped GPU memory
+     * 
+     * @param mapped a pointer to the start of the mapped GPU memory
+     * @param end the amount of bytes at the start of the buffer the copy is limited to
+     */
+    void uploadDirty(void* mapped, uint64_t end) noexcept;
+
     /**
      * @brief queue this cycle buffer backend instance for updating
      */
@@ -92,10 +128,12 @@ protected:
     uint32_t m_buff = 0;
     //store the size of the buffer
     uint64_t m_size = 0;
-    //store a synchronization primitive
-    void* m_sync = nullptr;
+    //store the index of the frame the GPU consumed this buffer in last
+    uint64_t m_usedFrame = 0;
     //store the mapped pointer
     void* m_mapped = nullptr;
+    //store the slice of the pool the buffer lives in (empty if the buffer is not pooled)
+    BufferPool::Slice m_slice;
     //store if an update is requested
     std::atomic_bool m_update{false};
 
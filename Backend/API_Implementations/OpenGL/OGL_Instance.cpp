@@ -29,6 +29,12 @@ using namespace GLGE::Graphic::Backend::OGL;
 
 //add the backend cycle buffer
 #include "OGL_CycleBuffer.h"
+//add the pool for small buffers
+#include "OGL_BufferPool.h"
+//add the staging ring
+#include "OGL_StagingRing.h"
+//add the state cache
+#include "OGL_StateCache.h"
 
 // Debug callback function for OpenGL
 void OpenGLDebugCallback(GLenum source, GLenum type, GLuint id, GLenum severity,
@@ -101,6 +107,9 @@ Instance::Instance(Window* window)
         std::cerr << "[WARNING] GLGE expexts a GPU to support " << GLGE_MAX_MATERIAL_TEXTURE_BINDING << " texture units. The current GPU supports only " << units << " texture units. Some pipelines may not work correctly.\n"; 
     }
 
+    //let the vertex and index buffer grow geometrically so streaming in meshes does not resize on every mesh
+    m_vertexBuffer.setGrowthPolicy(API::MemoryArena::GROW_DOUBLE);
+    m_indexBuffer.setGrowthPolicy(API::MemoryArena::GROW_DOUBLE);
     //force the vertex and index buffer to create itself
     ((OGL::Buffer*)m_vertexBuffer.getBuffer())->forceCreate();
     ((OGL::Buffer*)m_indexBuffer.getBuffer())->forceCreate();
@@ -110,6 +119,13 @@ Instance::Instance(Window* window)
 
 Instance::~Instance()
 {
+    //the frame fences are owned by the context
+    for (const FrameFence& fence : m_frameFences) {glDeleteSync((GLsync)fence.sync);}
+    m_frameFences.clear();
+    //the pooled buffers are owned by the context
+    BufferPool::clear();
+    //the staging ring is owned by the context, too
+    StagingRing::clear();
     //clean up the OpenGL context
     if (m_glContext) {
         //clean up the OpenGL context
@@ -118,6 +134,36 @@ Instance::~Instance()
     }
 }
 
+void Instance::onBeginTick() noexcept
+{
+    //close the current frame with a single fence
+    uint64_t frame = s_currentFrame.load(std::memory_order_acquire);
+    m_frameFences.push_back({frame, (void*)glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0)});
+    //the staging memory of the frame is protected by the same fence
+    StagingRing::endFrame(frame);
+    //publish the amount of state changes the state cache filtered
+    StateCache::endFrame();
+    s_currentFrame.store(frame + 1, std::memory_order_release);
+
+    //the GPU finishes the frames in order, so check from the oldest frame on
+    while (m_frameFences.size()) {
+        //timeout 0 means non-blocking
+        GLenum res = glClientWaitSync((GLsync)m_frameFences.front().sync, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+        //stop at the first frame that is not finished
+        if ((res == GL_TIMEOUT_EXPIRED) || (res == GL_WAIT_FAILED)) {break;}
+        //the frame is finished
+        s_completedFrame.store(m_frameFences.front().frame, std::memory_order_release);
+        glDeleteSync((GLsync)m_frameFences.front().sync);
+        m_frameFences.pop_front();
+    }
+}
+
+uint64_t Instance::getEliminatedStateCalls() noexcept
+{
+    //the statistics are kept by the state cache
+    return StateCache::getEliminatedCalls();
+}
+
 void Instance::onUpdate() noexcept
 {
     //update the cycle backend buffer
@@ -154,6 +200,12 @@ void Instance::onUpdate() noexcept
     }
 }
 
+void Instance::setBufferPooling(bool enabled) noexcept
+{
+    //just forward to the pool
+    BufferPool::setEnabled(enabled);
+}
+
 uint32_t Instance::getWindowFlags() noexcept
 {
     //return the OpenGL flag
@@ -22,6 +22,10 @@
 #include "../../../../GLGE_Core/Types.h"
 //add memory arenas
 #include "OGL_MemoryArena.h"
+//add a deque to store the fences of all frames in flight
+#include <deque>
+//add atomics to read the completed frame from any thread
+#include <atomic>
 
 //a window is required to create graphic stuff
 class Window;
@@ -70,11 +74,49 @@ public:
      */
     static uint32_t getWindowFlags() noexcept;
 
+    /**
+     * @brief close the current frame with a fence and check which frames the GPU finished
+     */
+    virtual void onBeginTick() noexcept override;
+
     /**
      * @brief tick the instance
      */
     virtual void onUpdate() noexcept override;
 
+    /**
+     * @brief Set if small buffers are stored as slices of a few large pooled buffers
+     * 
+     * @param enabled true : small buffers are pooled | false : each buffer uses its own OpenGL buffers
+     */
+    virtual void setBufferPooling(bool enabled) noexcept override;
+
+    /**
+     * @brief Get the index of the frame that is currently recorded
+     * 
+     * All commands submitted until the next tick belong to this frame. 
+     * 
+     * @return uint64_t the index of the current frame
+     */
+    inline static uint64_t getCurrentFrame() noexcept {return s_currentFrame.load(std::memory_order_acquire);}
+
+    /**
+     * @brief Get the index of the last frame the GPU finished
+     * 
+     * Resources that were last used in a frame with an index less or equal to this one are no longer used by the GPU. 
+     * This may be called from any thread. 
+     * 
+     * @return uint64_t the index of the last completed frame
+     */
+    inline static uint64_t getCompletedFrame() noexcept {return s_completedFrame.load(std::memory_order_acquire);}
+
+    /**
+     * @brief Get the amount of redundant OpenGL state changes the state cache filtered during the last frame
+     * 
+     * @return uint64_t the amount of eliminated OpenGL calls
+     */
+    static uint64_t getEliminatedStateCalls() noexcept;
+
     /**
      * @brief Get the loaded Extensions
      * 
@@ -90,13 +132,31 @@ protected:
     void* m_glContext = nullptr;
 
     //store the vertex buffer for the instance
-    OGL::MemoryArena m_vertexBuffer{0,true,Buffer::Type::VERTEX_BUFFER};
+    //a lot of meshes are streamed in and out, so use the constant time allocator
+    OGL::MemoryArena m_vertexBuffer{0,true,Buffer::Type::VERTEX_BUFFER,OGL::MemoryArena::TLSF};
     //store the index buffer for the instance
-    OGL::MemoryArena m_indexBuffer{0,true,Buffer::Type::INDEX_BUFFER};
+    OGL::MemoryArena m_indexBuffer{0,true,Buffer::Type::INDEX_BUFFER,OGL::MemoryArena::TLSF};
 
     //store the loaded extensions
     LoadedExtensions m_extensions;
 
+    /**
+     * @brief store the fence that marks the end of a frame
+     */
+    struct FrameFence {
+        //the index of the frame
+        uint64_t frame;
+        //the OpenGL sync object
+        void* sync;
+    };
+
+    //store the fences of all frames the GPU did not finish yet, the oldest frame is first
+    std::deque<FrameFence> m_frameFences;
+    //store the index of the frame that is currently recorded (read by threads that retire GPU memory)
+    inline static std::atomic_uint64_t s_currentFrame{1};
+    //store the index of the last frame the GPU finished
+    inline static std::atomic_uint64_t s_completedFrame{0};
+
 };
 
 };
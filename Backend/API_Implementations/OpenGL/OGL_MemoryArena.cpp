@@ -0,0 +1,29 @@
+/**
+ * @file OGL_MemoryArena.cpp
+ * @author DM8AT
+ * @brief implement the frame timeline of the OpenGL memory arena
+ * @version 0.1
+ * @date 2025-11-17
+ * 
+ * @copyright Copyright (c) 2025
+ * 
+ */
+//add the memory arena
+#include "OGL_MemoryArena.h"
+//add the instance for the frame timeline
+#include "OGL_Instance.h"
+
+//use the OpenGL namespace
+using namespace GLGE::Graphic::Backend::OGL;
+
+uint64_t MemoryArena::getCurrentFrame() const noexcept
+{
+    //the arena follows the frame timeline of the instance
+    return Instance::getCurrentFrame();
+}
+
+uint64_t MemoryArena::getCompletedFrame() const noexcept
+{
+    //the arena follows the frame timeline of the instance
+    return Instance::getCompletedFrame();
+}
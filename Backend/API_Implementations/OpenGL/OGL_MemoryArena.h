@@ -17,6 +17,8 @@
 #include "../API_MemoryArena.h"
 //add OpenGL buffers
 #include "OGL_Buffer.h"
+//add vectors to store the pages
+#include <vector>
 
 //only available for C++
 #if __cplusplus
@@ -38,20 +40,75 @@ public:
      * @param size the starting size of the memory arena
      * @param allowResize specify if the memory arena can change the size
      * @param type the type of buffer to use for the memory arena
+     * @param strategy the strategy that is used to manage the free regions of the arena
      */
-    MemoryArena(uint64_t size, bool allowResize, Buffer::Type type)
-     : m_buffer(nullptr, 0, type), API::MemoryArena(size, allowResize, &m_buffer)
+    MemoryArena(uint64_t size, bool allowResize, Buffer::Type type, Strategy strategy = FIRST_FIT)
+     : m_buffer(nullptr, 0, type), API::MemoryArena(size, allowResize, &m_buffer, strategy)
     {}
 
     /**
      * @brief Destroy the Memory Arena
      */
-    virtual ~MemoryArena() = default;
+    virtual ~MemoryArena()
+    {
+        //delete the buffers of all additional pages
+        for (OGL::Buffer* page : m_pageBuffers) {delete page;}
+        m_pageBuffers.clear();
+    }
 
 protected:
 
+    /**
+     * @brief create the buffer for a new page
+     * 
+     * @param size the size of the page in bytes
+     * @return `API::Buffer*` a pointer to the new buffer
+     */
+    virtual API::Buffer* createPage(uint64_t size) noexcept override
+    {
+        //create a new buffer of the same type as the first page
+        OGL::Buffer* page = new OGL::Buffer(nullptr, 0, m_buffer.getType());
+        //give the page its storage
+        page->resize(size);
+        //the arena owns the page
+        m_pageBuffers.push_back(page);
+        return page;
+    }
+
+    /**
+     * @brief destroy the buffer of a page
+     * 
+     * @param buffer the buffer of the page to destroy
+     */
+    virtual void destroyPage(API::Buffer* buffer) noexcept override
+    {
+        //find the page and remove it from the owned pages
+        for (size_t i = 0; i < m_pageBuffers.size(); ++i) {
+            if (m_pageBuffers[i] != buffer) {continue;}
+            delete m_pageBuffers[i];
+            m_pageBuffers.erase(m_pageBuffers.begin() + i);
+            return;
+        }
+    }
+
+    /**
+     * @brief Get the index of the frame that is currently recorded
+     * 
+     * @return uint64_t the index of the current frame of the OpenGL instance
+     */
+    virtual uint64_t getCurrentFrame() const noexcept override;
+
+    /**
+     * @brief Get the index of the last frame the GPU finished
+     * 
+     * @return uint64_t the index of the last completed frame of the OpenGL instance
+     */
+    virtual uint64_t getCompletedFrame() const noexcept override;
+
     //store the buffer for the memory arena
     OGL::Buffer m_buffer;
+    //store the buffers for all pages except the first one
+    std::vector<OGL::Buffer*> m_pageBuffers;
 
 };
 
@@ -27,9 +27,16 @@
 //add framebuffers
 #include "../../../Frontend/Framebuffer.h"
 #include "OGL_Framebuffer.h"
+//add the state cache
+#include "OGL_StateCache.h"
+
+//add the record pool to record stages in parallel
+#include "../API_RecordPool.h"
 
 //unordered maps are used to store the mapping from material -> list of meshes
 #include <unordered_map>
+//tuples are used as batch keys
+#include <tuple>
 
 //add OpenGL
 #include "glad/glad.h"
@@ -38,53 +45,67 @@
 using namespace GLGE::Graphic::Backend::OGL;
 
 /**
- * @brief get the framebuffer target of a specific render target
+ * @brief get the framebuffer of a specific render target
  * 
  * @param target the target to get the framebuffer from
- * @return uint32_t the OpenGL framebuffer of the target
+ * @return GLGE::Graphic::Backend::OGL::Framebuffer* the OpenGL framebuffer of the target or nullptr for the window
  */
-static uint32_t __GetFramebufferTarget(const RenderTarget& target) {
+static GLGE::Graphic::Backend::OGL::Framebuffer* __GetFramebufferTarget(const RenderTarget& target) {
     //switch depending on the target type
     switch (target.type)
     {
     case GLGE_WINDOW:
-        //the window target is always 0 on OpenGL
-        return 0;
+        //the window target is always the default framebuffer on OpenGL
+        return nullptr;
         break;
     case GLGE_FRAMEBUFFER:
         //return the OpenGL framebuffer
-        return ((GLGE::Graphic::Backend::OGL::Framebuffer*)((::Framebuffer*)target.target)->getAPI())->getFBO();
+        return (GLGE::Graphic::Backend::OGL::Framebuffer*)((::Framebuffer*)target.target)->getAPI();
         break;
     
     default:
         //how did we get here?
         GLGE_ABORT("Undefined render target type");
-        return UINT32_MAX;
+        return nullptr;
         break;
     }
 }
 
-void GLGE::Graphic::Backend::OGL::RenderPipeline::executeStage_Custom(const RenderPipelineStageData& _stage) noexcept
+GLGE::Graphic::Backend::OGL::RenderPipeline::~RenderPipeline()
+{
+    //delete all buffers the frames still own
+    for (Frame& frame : m_frames) {
+        for (const RecordedStage& stage : frame.stages) {
+            for (const BatchUpload& upload : stage.uploads) 
+            {frame.customBuffs.insert(frame.customBuffs.end(), upload.buffers.begin(), upload.buffers.end());}
+        }
+        if (frame.customBuffs.size()) 
+        {glDeleteBuffers(frame.customBuffs.size(), frame.customBuffs.data());}
+    }
+}
+
+void GLGE::Graphic::Backend::OGL::RenderPipeline::executeStage_Custom(const RenderPipelineStageData& _stage, RecordedStage& target) noexcept
 {
     //extract the stage
     const RenderPipelineStageData::CustomStage& stage = _stage.customStage;
 
     //add the custom stage
-    m_cmdBuff.record<Command_Custom>(stage.custom_func, stage.userData);
+    target.cmdBuff.record<Command_Custom>(stage.custom_func, stage.userData);
 }
 
-void GLGE::Graphic::Backend::OGL::RenderPipeline::executeStage_SimpleDrawRenderMesh(const RenderPipelineStageData& _stage) noexcept
+void GLGE::Graphic::Backend::OGL::RenderPipeline::executeStage_SimpleDrawRenderMesh(const RenderPipelineStageData& _stage, RecordedStage& target) noexcept
 {
     //extract the stage
     const RenderPipelineStageData::SimpleDrawRenderMesh& stage = _stage.simpleDrawRenderMesh;
 
     //bind the material of the render mesh
-    m_cmdBuff.record<Command_BindMaterial>((OGL::Material*)((::Material*)stage.material)->getBackend());
+    target.cmdBuff.record<Command_BindMaterial>((OGL::Material*)((::Material*)stage.material)->getBackend());
     //draw the render mesh
-    m_cmdBuff.record<Command_DrawMesh>((API::RenderMesh*)(RenderMeshRegistry::get(stage.handle))->getBackend());
+    target.cmdBuff.record<Command_DrawMesh>((API::RenderMesh*)(RenderMeshRegistry::get(stage.handle))->getBackend(), 
+                                                  (OGL::Material*)((::Material*)stage.material)->getBackend());
 }
 
-void GLGE::Graphic::Backend::OGL::RenderPipeline::executeStage_DrawScene(const RenderPipelineStageData& _stage) noexcept
+void GLGE::Graphic::Backend::OGL::RenderPipeline::executeStage_DrawScene(const RenderPipelineStageData& _stage, RecordedStage& target) noexcept
 {
     //extract the stage
     const RenderPipelineStageData::DrawScene& stage = _stage.drawScene;
@@ -92,109 +113,90 @@ void GLGE::Graphic::Backend::OGL::RenderPipeline::executeStage_DrawScene(const R
     //BATCHING STEP
 
     //store all the batches
-    //the batches are stored by mapping a material pointer to an std::vector of render mesh handles
-    std::map<::Material*, std::vector<std::pair<uint32_t, RenderMeshHandle>>> batches;
-
-    //get all objects from the scene that have a renderer component
-    std::vector<std::pair<Object, Renderer*>> toBatch = ((Scene*)stage.scene)->get<Renderer>();
-    //iterate over all object - renderer pairs
-    for (auto& pair : toBatch) {
-        //iterate over all mesh - material pairs in the renderer
-        for (size_t i = 0; i < pair.second->getElementCount(); ++i) {
-            //check if the material is known
-            const RenderObject& obj = pair.second->getObject(i);
-            auto pos = batches.find(obj.material);
-            if (pos == batches.end()) {
-                //if not, create a new entry
-                batches.emplace(obj.material, std::initializer_list{std::pair<uint32_t, RenderMeshHandle>(
-                    pair.second->getRenderObjectHandle(), obj.handle)});
-            } else {
-                //if it exists, just add the handle to the map
-                pos->second.push_back(std::pair<uint32_t, RenderMeshHandle>(pair.second->getRenderObjectHandle(), obj.handle));
-            }
+    //the batches are stored by mapping a material pointer and the vertex and index pages to an std::vector of render mesh handles
+    //a single indirect draw can only read from one vertex and one index page
+    std::map<std::tuple<::Material*, uint32_t, uint32_t>, std::vector<std::pair<uint32_t, RenderMeshHandle>>> batches;
+
+    //the scene is only read through the copy that was made when the recording was requested
+    //the copy is stored at the same index as the recording of the stage
+    const std::vector<SceneEntry>& scene = m_recording->scenes[&target - m_recording->stages.data()];
+    //iterate over all render objects of the scene
+    for (const SceneEntry& obj : scene) {
+        //check if the material - page combination is known
+        std::tuple<::Material*, uint32_t, uint32_t> key(obj.material, obj.vertexPage, obj.indexPage);
+        auto pos = batches.find(key);
+        if (pos == batches.end()) {
+            //if not, create a new entry
+            batches.emplace(key, std::initializer_list{std::pair<uint32_t, RenderMeshHandle>(obj.object, obj.mesh)});
+        } else {
+            //if it exists, just add the handle to the map
+            pos->second.push_back(std::pair<uint32_t, RenderMeshHandle>(obj.object, obj.mesh));
         }
     }
 
     //BATCH PREPARATION STEP
 
-    //prepare all buffers
-    std::vector<uint32_t> buffs;
-    buffs.resize(batches.size() + 1);
-    //create all buffers
-    glCreateBuffers(buffs.size(), buffs.data());
-    //store the most meshes ever found
-    //this is used to set up the draw buffer correctly
-    size_t maxMeshCount = 0;
-    //iterate over all buffers and fill them with the correct data
-    size_t buff = 0;
-    for (auto& [material, objList] : batches) {
+    //the buffers are created when the frame is played, as recording does not use OpenGL
+    target.uploads.emplace_back();
+    BatchUpload& upload = target.uploads.back();
+    upload.counts.reserve(batches.size());
+    //collect the data of all batches
+    for (auto& [key, objList] : batches) {
         //store the object and mesh to draw
-        std::vector<uint64_t> pair;
-        pair.reserve(objList.size());
-        //collect the data
         for (size_t i = 0; i < objList.size(); ++i) 
-        {pair.push_back(((uint64_t)objList[i].first) | (((uint64_t)objList[i].second.idx) << 32));}
-        //upload the data to the GPU
-        glNamedBufferStorage(buffs[buff], pair.size()*sizeof(uint64_t), pair.data(), 0);
-
-        //update the new max mesh count
-        maxMeshCount = (maxMeshCount > pair.size()) ? maxMeshCount : pair.size();
-
-        //step to the next buffer
-        ++buff;
+        {upload.pairs.push_back(((uint64_t)objList[i].first) | (((uint64_t)objList[i].second.idx) << 32));}
+        upload.counts.push_back(objList.size());
     }
-
-    //setup the last buffer as a draw buffer
-    uint32_t drawBuffer = buffs[buffs.size() - 1];
-    //allocate enough data for all draw elements
-    //(it is important to know that one indirect draw structure is 20 bytes)
-    glNamedBufferStorage(drawBuffer, maxMeshCount*20, nullptr, 0);
+    //upload the data before drawing
+    target.cmdBuff.record<Command_UploadBatches>(&upload);
 
     //DRAWING STEP
 
     //iterate over all computed batches
     //store the current batch id
-    size_t batch_id = 0;
+    uint32_t batch_id = 0;
     for (auto& batch : batches) {
         //draw the batches
-        m_cmdBuff.record<Command_DrawMeshesIndirect>(stage.camera, (OGL::Material*)batch.first->getBackend(), batch.second.size(), 
-                                                     buffs[batch_id], drawBuffer, stage.batchShader, stage.batchShaderCount);
+        //the compute shaders to run before drawing are stored directly behind the command
+        target.cmdBuff.recordExtended<Command_DrawMeshesIndirect>(stage.batchShader, stage.batchShaderCount * sizeof(void*), 
+                                                                  stage.camera, (OGL::Material*)std::get<0>(batch.first)->getBackend(), &upload, batch_id, 
+                                                                  (uint32_t)stage.batchShaderCount, std::get<1>(batch.first), std::get<2>(batch.first));
 
         //step the batch id
         ++batch_id;
     }
 }
 
-void GLGE::Graphic::Backend::OGL::RenderPipeline::executeStage_DispatchCompute(const RenderPipelineStageData& _stage) noexcept
+void GLGE::Graphic::Backend::OGL::RenderPipeline::executeStage_DispatchCompute(const RenderPipelineStageData& _stage, RecordedStage& target) noexcept
 {
     //extract the stage
     const RenderPipelineStageData::DispatchCompute& stage = _stage.dispatchCompute;
 
     //simply queue the dispatch compute command
-    m_cmdBuff.record<Command_DispatchCompute>(stage.compute, stage.instances[0], stage.instances[1], stage.instances[2]);
+    target.cmdBuff.record<Command_DispatchCompute>(stage.compute, stage.instances[0], stage.instances[1], stage.instances[2]);
 }
 
-void GLGE::Graphic::Backend::OGL::RenderPipeline::executeStage_MemoryBarrier(const RenderPipelineStageData&) noexcept
+void GLGE::Graphic::Backend::OGL::RenderPipeline::executeStage_MemoryBarrier(const RenderPipelineStageData& _stage, RecordedStage& target) noexcept
 {
-    //simply run the memory barrier
-    m_cmdBuff.record<Command_MemoryBarrier>();
-}
-
-void GLGE::Graphic::Backend::OGL::RenderPipeline::executeStage_Cleanup(const RenderPipelineStageData&) noexcept
-{
-    //delete all command-made buffer if any exist
-    if (m_customBuffs.size()) 
-    {glDeleteBuffers(m_customBuffs.size(), m_customBuffs.data());}
-    m_customBuffs.clear();
-}
-
-void GLGE::Graphic::Backend::OGL::RenderPipeline::executeStage_Finalize(const RenderPipelineStageData&) noexcept
-{
-    //recording done
-    m_cmdBuff.markRecorded();
+    //get the stage
+    const RenderPipelineStageData::Barrier& stage = _stage.barrier;
+
+    //convert the barrier bits to OpenGL (no bits means all bits)
+    uint32_t bits = (stage.barriers == GLGE_BARRIER_ALL) ? GL_ALL_BARRIER_BITS : 0;
+    bits |= (stage.barriers & GLGE_BARRIER_VERTEX_DATA) ? GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT : 0;
+    bits |= (stage.barriers & GLGE_BARRIER_INDEX_DATA) ? GL_ELEMENT_ARRAY_BARRIER_BIT : 0;
+    bits |= (stage.barriers & GLGE_BARRIER_UNIFORM_BUFFER) ? GL_UNIFORM_BARRIER_BIT : 0;
+    bits |= (stage.barriers & GLGE_BARRIER_STORAGE_BUFFER) ? GL_SHADER_STORAGE_BARRIER_BIT : 0;
+    bits |= (stage.barriers & GLGE_BARRIER_TEXTURE_FETCH) ? GL_TEXTURE_FETCH_BARRIER_BIT : 0;
+    bits |= (stage.barriers & GLGE_BARRIER_INDIRECT_COMMAND) ? GL_COMMAND_BARRIER_BIT : 0;
+    bits |= (stage.barriers & GLGE_BARRIER_FRAMEBUFFER) ? GL_FRAMEBUFFER_BARRIER_BIT : 0;
+    bits |= (stage.barriers & GLGE_BARRIER_BUFFER_UPDATE) ? GL_BUFFER_UPDATE_BARRIER_BIT : 0;
+
+    //record the memory barrier
+    target.cmdBuff.record<Command_MemoryBarrier>(bits);
 }
 
-void GLGE::Graphic::Backend::OGL::RenderPipeline::executeStage_Blit(const RenderPipelineStageData& _stage) noexcept
+void GLGE::Graphic::Backend::OGL::RenderPipeline::executeStage_Blit(const RenderPipelineStageData& _stage, RecordedStage& target) noexcept
 {
     //get the stage
     const RenderPipelineStageData::Blit& stage = _stage.blit;
@@ -206,22 +208,22 @@ void GLGE::Graphic::Backend::OGL::RenderPipeline::executeStage_Blit(const Render
     mask |= stage.copyStencil ? GL_STENCIL_BUFFER_BIT : 0;
 
     //extract the framebuffers
-    uint32_t from = __GetFramebufferTarget(stage.from.target);
-    uint32_t to   = __GetFramebufferTarget(stage.to.target);
+    OGL::Framebuffer* from = __GetFramebufferTarget(stage.from.target);
+    OGL::Framebuffer* to   = __GetFramebufferTarget(stage.to.target);
 
     //get the filter
     uint32_t filter = (stage.filter == GLGE_FILTER_MODE_NEAREST) ? GL_NEAREST : GL_LINEAR;
 
     //record the command
-    m_cmdBuff.record<Command_Blit>(from, stage.from.extend, stage.from.offset, to, stage.to.extend, stage.to.offset, filter, mask);
+    target.cmdBuff.record<Command_Blit>(from, stage.from.extend, stage.from.offset, to, stage.to.extend, stage.to.offset, filter, mask);
 }
 
-void GLGE::Graphic::Backend::OGL::RenderPipeline::executeStage_Clear(const RenderPipelineStageData& _stage) noexcept {
+void GLGE::Graphic::Backend::OGL::RenderPipeline::executeStage_Clear(const RenderPipelineStageData& _stage, RecordedStage& target) noexcept {
     //get the stage
     const RenderPipelineStageData::Clear& stage = _stage.clear;
 
     //get the framebuffer
-    uint32_t fbuff = ((OGL::Framebuffer*)((::Framebuffer*)stage.fbuff)->getAPI())->getFBO();
+    OGL::Framebuffer* fbuff = (OGL::Framebuffer*)((::Framebuffer*)stage.fbuff)->getAPI();
     //get the type of the buffer
     uint32_t buffType = GL_COLOR;
     switch (stage.type)
@@ -241,67 +243,142 @@ void GLGE::Graphic::Backend::OGL::RenderPipeline::executeStage_Clear(const Rende
     }
     
     //record the clear command
-    m_cmdBuff.record<Command_Clear>(stage.value.r, stage.value.g, stage.value.b, stage.value.a, fbuff, buffType, stage.attachment);
+    target.cmdBuff.record<Command_Clear>(stage.value.r, stage.value.g, stage.value.b, stage.value.a, fbuff, buffType, stage.attachment);
 }
 
-void GLGE::Graphic::Backend::OGL::RenderPipeline::record() noexcept
+void GLGE::Graphic::Backend::OGL::RenderPipeline::record(uint8_t frame) noexcept
 {
-    //clean the command buffer
-    m_cmdBuff.clear();
+    //select the frame slot to record to
+    m_recording = &m_frames[frame];
+    //make sure each stage has its own recording
+    bool resized = m_recording->stages.size() != m_pipeline->getStages().size();
+    m_recording->stages.resize(m_pipeline->getStages().size());
     //cash the clear color
-    m_clearColor = (m_pipeline->getWindow()) ? m_pipeline->getWindow()->getClearColor() : 0;
-    //make enough space in the todo-buffer
-    m_todo.resize(m_pipeline->getStages().size() + 2);
-    //also add a cleanup stage
-    m_todo[0] = std::pair<RenderPipelineStageData, void (RenderPipeline::*)(const RenderPipelineStageData&)>
-                (RenderPipelineStageData{}, &RenderPipeline::executeStage_Cleanup);
-    //just iterate over all stages and play them
-    uint64_t id = 1;
-    for (auto it = m_pipeline->getStages().begin(); it != m_pipeline->getStages().end(); ++it)
-    {execute(*it, id); ++id;}
-    //record the finalization stage
-    m_todo[m_todo.size()-1] = std::pair<RenderPipelineStageData, void (RenderPipeline::*)(const RenderPipelineStageData&)>
-                              (RenderPipelineStageData{}, &RenderPipeline::executeStage_Finalize);
+    m_recording->clearColor = (m_pipeline->getWindow()) ? m_pipeline->getWindow()->getClearColor() : 0;
+    //collect all stages that need to be recorded again
+    m_toRecord.clear();
+    for (uint64_t i = 0; i < m_pipeline->getStages().size(); ++i) 
+    {if (prepareStage(m_pipeline->getStages()[i], i)) {m_toRecord.push_back(i);}}
+    //record the stages in parallel, each stage writes only to its own command buffer
+    API::RecordPool::run(m_toRecord.size(), &RenderPipeline::recordJob, this);
+
+    //stitch the stages together if any stage changed
+    if (m_toRecord.size() || resized || !m_recording->commands.isRecorded()) {
+        m_recording->commands.clear();
+        for (const RecordedStage& stage : m_recording->stages) {m_recording->commands.append(stage.cmdBuff);}
+        //if requested, sort the draws of the whole frame, so draws of consecutive stages are sorted together
+        if (m_pipeline->getDrawSorting()) {m_recording->commands.sortDraws();}
+        //if requested, insert the memory barriers the frame needs
+        if (m_pipeline->getAutomaticBarriers()) {m_recording->commands.insertBarriers();}
+        //if requested, optimize the commands of the whole frame
+        if (m_pipeline->getCommandOptimization()) {
+            m_recording->commands.optimize();
+            m_removedCommands.store(m_recording->commands.getRemovedCommands(), std::memory_order_relaxed);
+            m_mergedCommands.store(m_recording->commands.getMergedCommands(), std::memory_order_relaxed);
+        } else {
+            m_removedCommands.store(0, std::memory_order_relaxed);
+            m_mergedCommands.store(0, std::memory_order_relaxed);
+        }
+        m_recording->commands.markRecorded();
+    }
+    //recording done
+    m_recording = nullptr;
+}
+
+void GLGE::Graphic::Backend::OGL::RenderPipeline::snapshot(uint8_t frame) noexcept
+{
+    //get the frame slot that is recorded next
+    Frame& target = m_frames[frame];
+    const std::vector<RenderPipelineStage>& stages = m_pipeline->getStages();
+    target.scenes.resize(stages.size());
+    for (uint64_t i = 0; i < stages.size(); ++i) {
+        //the memory of the last copy is re-used
+        target.scenes[i].clear();
+        if (stages[i].type != GLGE_RENDER_PIPELINE_STAGE_DRAW_SCENE) {continue;}
+
+        //get all objects from the scene that have a renderer component
+        std::vector<std::pair<Object, Renderer*>> renderers = ((Scene*)stages[i].data.drawScene.scene)->get<Renderer>();
+        //iterate over all object - renderer pairs
+        for (auto& pair : renderers) {
+            //iterate over all mesh - material pairs in the renderer
+            for (size_t j = 0; j < pair.second->getElementCount(); ++j) {
+                const RenderObject& obj = pair.second->getObject(j);
+                API::RenderMesh* rMesh = (API::RenderMesh*)(RenderMeshRegistry::get(obj.handle))->getBackend();
+                target.scenes[i].push_back({pair.second->getRenderObjectHandle(), obj.handle, obj.material, 
+                                            rMesh->getVertexPointer().page, rMesh->getIndexPointer().page});
+            }
+        }
+    }
+}
+
+void GLGE::Graphic::Backend::OGL::RenderPipeline::recordJob(void* pipeline, uint64_t idx) noexcept
+{
+    //get the pipeline and the stage to record
+    RenderPipeline* pipe = (RenderPipeline*)pipeline;
+    uint64_t stageIndex = pipe->m_toRecord[idx];
+    //record the stage
+    pipe->recordStage(pipe->m_pipeline->getStages()[stageIndex], pipe->m_recording->stages[stageIndex]);
 }
 
 void GLGE::Graphic::Backend::OGL::RenderPipeline::execute(const RenderPipelineStage& stage, uint64_t stageIndex) noexcept
 {
-    //get the pair of the todo list to write to
-    auto& todo = m_todo[stageIndex];
-    //store the data
-    RenderPipelineStageData data = stage.data;
-    //store the function to call
-    void (OGL::RenderPipeline::* func)(const RenderPipelineStageData &stage) = nullptr;
-
-    //switch over the stage type to do the correct stuff
+    //record the stage on the calling thread if needed
+    if (prepareStage(stage, stageIndex)) {recordStage(stage, m_recording->stages[stageIndex]);}
+}
+
+bool GLGE::Graphic::Backend::OGL::RenderPipeline::prepareStage(const RenderPipelineStage& stage, uint64_t stageIndex) noexcept
+{
+    //get the recording of the stage
+    RecordedStage& target = m_recording->stages[stageIndex];
+    uint32_t version = m_pipeline->getStageVersion(stageIndex);
+    //if the stage did not change since the last recording, the commands can be played again
+    if (target.cmdBuff.isRecorded() && (stage.type != GLGE_RENDER_PIPELINE_STAGE_DRAW_SCENE) && (target.version == version) && 
+        (memcmp(target.stage, &stage, sizeof(RenderPipelineStage)) == 0)) 
+    {return false;}
+
+    //the buffers of the last recording are deleted before the slot is played again
+    for (const BatchUpload& upload : target.uploads) 
+    {m_recording->customBuffs.insert(m_recording->customBuffs.end(), upload.buffers.begin(), upload.buffers.end());}
+    target.uploads.clear();
+    //clean the command buffer
+    target.cmdBuff.clear();
+    //store what the commands are recorded from
+    memcpy(target.stage, &stage, sizeof(RenderPipelineStage));
+    target.version = version;
+    return true;
+}
+
+void GLGE::Graphic::Backend::OGL::RenderPipeline::recordStage(const RenderPipelineStage& stage, RecordedStage& target) noexcept
+{
+    //switch over the stage type to record the correct stuff
     switch (stage.type)
     {
     case GLGE_RENDER_PIPELINE_STAGE_CUSTOM:
-        func = &RenderPipeline::executeStage_Custom;
+        executeStage_Custom(stage.data, target);
         break;
 
     case GLGE_RENDER_PIPELINE_STAGE_SIMPLE_DRAW_RENDER_MESH:
-        func = &RenderPipeline::executeStage_SimpleDrawRenderMesh;
+        executeStage_SimpleDrawRenderMesh(stage.data, target);
         break;
 
     case GLGE_RENDER_PIPELINE_STAGE_DRAW_SCENE:
-        func = &RenderPipeline::executeStage_DrawScene;
+        executeStage_DrawScene(stage.data, target);
         break;
 
     case GLGE_RENDER_PIPELINE_DISPATCH_COMPUTE:
-        func = &RenderPipeline::executeStage_DispatchCompute;
+        executeStage_DispatchCompute(stage.data, target);
         break;
 
     case GLGE_RENDER_PIPELINE_MEMORY_BARRIER:
-        func = &RenderPipeline::executeStage_MemoryBarrier;
+        executeStage_MemoryBarrier(stage.data, target);
         break;
 
     case GLGE_RENDER_PIPELINE_BLIT:
-        func = &RenderPipeline::executeStage_Blit;
+        executeStage_Blit(stage.data, target);
         break;
 
     case GLGE_RENDER_PIPELINE_CLEAR:
-        func = &RenderPipeline::executeStage_Clear;
+        executeStage_Clear(stage.data, target);
         break;
     
     default:
@@ -309,19 +386,21 @@ void GLGE::Graphic::Backend::OGL::RenderPipeline::execute(const RenderPipelineSt
         break;
     }
 
-    //record the actual stage
-    todo.emplace(data, func);
+    //the stage is recorded
+    target.cmdBuff.markRecorded();
 }
 
 
-void GLGE::Graphic::Backend::OGL::RenderPipeline::play() noexcept
+void GLGE::Graphic::Backend::OGL::RenderPipeline::play(uint8_t frame) noexcept
 {
-    //first, clean up the todo list
-    for (size_t i = 0; i < m_todo.size(); ++i) {
-        (this->*m_todo[i].value().second)(m_todo[i].value().first);
-    }
-    //todo list is done
-    m_todo.clear();
+    //get the frame slot to play
+    Frame& toPlay = m_frames[frame];
+    //first, clean up the buffers of the last recording in this slot
+    if (toPlay.customBuffs.size()) 
+    {glDeleteBuffers(toPlay.customBuffs.size(), toPlay.customBuffs.data());}
+    toPlay.customBuffs.clear();
+    //OpenGL objects may have been deleted and re-created since the last playback, so don't trust the cached state
+    StateCache::invalidate();
 
     //change the path of execution depending on if a window exists
     if (m_pipeline->getWindow()) {
@@ -330,14 +409,14 @@ void GLGE::Graphic::Backend::OGL::RenderPipeline::play() noexcept
         //then play back the command buffer if the window is not minimized
         if (!m_pipeline->getWindow()->getSettings().minimized) {
             //first, clear the window
-            ((OGL::Window*)m_pipeline->getWindow()->getAPI())->clearWindow(m_clearColor);
-            //just play back the command buffer
-            m_cmdBuff.play();
+            ((OGL::Window*)m_pipeline->getWindow()->getAPI())->clearWindow(toPlay.clearColor);
+            //just play back the stitched commands of all stages
+            toPlay.commands.play();
             //finally end the tick
             ((OGL::Window*)m_pipeline->getWindow()->getAPI())->endFrame();
         }
     } else {
         //if no window exists, just run the pipeline
-        m_cmdBuff.play();
+        toPlay.commands.play();
     }
-}
\ No newline at end of file
+}
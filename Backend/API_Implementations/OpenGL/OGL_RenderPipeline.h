@@ -21,8 +21,8 @@
 //only available for C++
 #if __cplusplus
 
-//add optionals for using data that MAY be there
-#include <optional>
+//add deques to store the batch uploads at stable addresses
+#include <deque>
 
 //add command buffers. They are required by the render pipeline
 #include "OGL_CommandBuffer.h"
@@ -48,11 +48,14 @@ public:
     /**
      * @brief Destroy the Render Pipeline
      */
-    virtual ~RenderPipeline() {}
+    virtual ~RenderPipeline();
 
     /**
      * @brief execute a single render pipeline stage using the API
      * 
+     * The commands recorded for the stage in the current frame slot are re-used if the stage did not change since. 
+     * Scene draws are always recorded again, as the scene may change at any time. 
+     * 
      * @param stage the stage to execute
      * @param stageIndex the id of the stage
      */
@@ -60,96 +63,187 @@ public:
 
     /**
      * @brief record the whole pipeline
+     * 
+     * Recording does not use OpenGL, so it can run on any thread. 
+     * All stages that need to be recorded again are recorded in parallel on the record pool into their own command buffers. 
+     * The command buffers are stitched together in the order of the stages, so the result does not depend on the amount of threads. 
+     * If requested, the stitched commands are optimized afterwards. 
+     * 
+     * @param frame the index of the frame slot to record to
      */
-    virtual void record() noexcept override;
+    virtual void record(uint8_t frame) noexcept override;
+
+    /**
+     * @brief copy the renderers of all drawn scenes
+     * 
+     * Scenes change on the thread that requests the recording, so the recording thread only reads the copy. 
+     * 
+     * @param frame the index of the frame slot that is recorded next
+     */
+    virtual void snapshot(uint8_t frame) noexcept override;
 
     /**
      * @brief play back a recorded render pipeline
+     * 
+     * @param frame the index of the frame slot to play
      */
-    virtual void play() noexcept override;
+    virtual void play(uint8_t frame) noexcept override;
 
     /**
-     * @brief Get the Clear Color of the pipeline
+     * @brief Get the Clear Color of a recorded frame
      * 
+     * @param frame the index of the frame slot
      * @return const vec4& the clear color of the window
      */
-    inline const vec4& getClearColor() const noexcept {return m_clearColor;}
+    inline const vec4& getClearColor(uint8_t frame) const noexcept {return m_frames[frame].clearColor;}
 
 protected:
 
+    /**
+     * @brief store the recorded commands of a single stage
+     * 
+     * The commands are kept and played again as long as the stage does not change. 
+     */
+    struct RecordedStage {
+        //store the commands of the stage
+        CommandBuffer cmdBuff;
+        //store a copy of the stage the commands were recorded from (raw bytes, as stages can't be default constructed)
+        uint8_t stage[sizeof(RenderPipelineStage)] = {0};
+        //store the version of the stage the commands were recorded from
+        uint32_t version = 0;
+        //store the batches of all scenes drawn by the stage
+        std::deque<BatchUpload> uploads;
+    };
+
+    /**
+     * @brief store a single render object of a scene as it was when the recording was requested
+     */
+    struct SceneEntry {
+        //the handle of the render object
+        uint32_t object;
+        //the render mesh to draw
+        RenderMeshHandle mesh;
+        //the material to draw with
+        ::Material* material;
+        //the page of the vertex data of the render mesh
+        uint32_t vertexPage;
+        //the page of the index data of the render mesh
+        uint32_t indexPage;
+    };
+
+    /**
+     * @brief store everything that belongs to a single recorded frame
+     */
+    struct Frame {
+        //store the recorded commands of each stage in the order of the stages
+        std::vector<RecordedStage> stages;
+        //store the render objects of the scene each stage draws (empty for stages that draw no scene)
+        std::vector<std::vector<SceneEntry>> scenes;
+        //store the commands of all stages stitched together in the order of the stages, this is what is played
+        CommandBuffer commands;
+        //store the clear color of the parent window
+        vec4 clearColor;
+        //store all command-made buffers that are deleted before the frame is played the next time
+        std::vector<uint32_t> customBuffs;
+    };
+
+    /**
+     * @brief check if a stage needs to be recorded again and prepare its recording if so
+     * 
+     * This touches data that is shared by all stages of the frame, so it must not run in parallel. 
+     * 
+     * @param stage the stage to check
+     * @param stageIndex the id of the stage
+     * @return true : the stage must be recorded again | false : the commands of the last recording can be played again
+     */
+    bool prepareStage(const RenderPipelineStage& stage, uint64_t stageIndex) noexcept;
+
+    /**
+     * @brief record the commands of a single prepared stage
+     * 
+     * Only the recording of the stage is written, so different stages can be recorded in parallel. 
+     * 
+     * @param stage the stage to record
+     * @param target the recorded stage to record the commands to
+     */
+    void recordStage(const RenderPipelineStage& stage, RecordedStage& target) noexcept;
+
+    /**
+     * @brief a job of the record pool that records a single stage
+     * 
+     * @param pipeline a pointer to the OpenGL render pipeline
+     * @param idx the index of the stage in the list of stages to record
+     */
+    static void recordJob(void* pipeline, uint64_t idx) noexcept;
+
     /**
      * @brief execute a custom stage
      * 
      * @param stage the data of the custom stage to execute
+     * @param target the recorded stage to record the commands to
      */
-    void executeStage_Custom(const RenderPipelineStageData& stage) noexcept;
+    void executeStage_Custom(const RenderPipelineStageData& stage, RecordedStage& target) noexcept;
 
     /**
      * @brief draw a simple render mesh
      * 
      * @param stage the stage data to execute on
+     * @param target the recorded stage to record the commands to
      */
-    void executeStage_SimpleDrawRenderMesh(const RenderPipelineStageData& stage) noexcept;
+    void executeStage_SimpleDrawRenderMesh(const RenderPipelineStageData& stage, RecordedStage& target) noexcept;
 
     /**
      * @brief draw a whole scene
      * 
      * @param stage the stage data to execute on
+     * @param target the recorded stage to record the commands to
      */
-    void executeStage_DrawScene(const RenderPipelineStageData& stage) noexcept;
+    void executeStage_DrawScene(const RenderPipelineStageData& stage, RecordedStage& target) noexcept;
 
     /**
      * @brief dispatch a compute shader
      * 
      * @param stage the stage data to execute on
+     * @param target the recorded stage to record the commands to
      */
-    void executeStage_DispatchCompute(const RenderPipelineStageData& stage) noexcept;
+    void executeStage_DispatchCompute(const RenderPipelineStageData& stage, RecordedStage& target) noexcept;
 
     /**
      * @brief run a memory barrier
      * 
      * @param stage the stage data to execute on
+     * @param target the recorded stage to record the commands to
      */
-    void executeStage_MemoryBarrier(const RenderPipelineStageData& stage) noexcept;
-
-    /**
-     * @brief clean up the old data
-     */
-    void executeStage_Cleanup(const RenderPipelineStageData&) noexcept;
-
-    /**
-     * @brief finalize the recording
-     */
-    void executeStage_Finalize(const RenderPipelineStageData&) noexcept;
+    void executeStage_MemoryBarrier(const RenderPipelineStageData& stage, RecordedStage& target) noexcept;
 
     /**
      * @brief blit from one element to another
      * 
      * @param stage the stage data to use for blitting
+     * @param target the recorded stage to record the commands to
      */
-    void executeStage_Blit(const RenderPipelineStageData& stage) noexcept;
+    void executeStage_Blit(const RenderPipelineStageData& stage, RecordedStage& target) noexcept;
 
     /**
      * @brief clear a specific framebuffer
      * 
      * @param stage the stage data to use for clearing
+     * @param target the recorded stage to record the commands to
      */
-    void executeStage_Clear(const RenderPipelineStageData& stage) noexcept;
+    void executeStage_Clear(const RenderPipelineStageData& stage, RecordedStage& target) noexcept;
 
     /**
-     * @brief store the OpenGL command buffer
+     * @brief store all frame slots, frames in flight use different slots
      */
-    CommandBuffer m_cmdBuff;
+    Frame m_frames[GLGE_MAX_FRAMES_IN_FLIGHT];
     /**
-     * @brief store the clear color of the parent window
+     * @brief store the frame slot that is currently recorded
      */
-    vec4 m_clearColor;
-
-    //store a list of all command-made buffers
-    std::vector<uint32_t> m_customBuffs;
-    //store a list of function pointers that are delayed till the first run
-    //this stores stages to execute later
-    std::vector<std::optional<std::pair<RenderPipelineStageData, void (RenderPipeline::*)(const RenderPipelineStageData& stage)>>> m_todo;
+    Frame* m_recording = nullptr;
+    /**
+     * @brief store the indices of all stages that are recorded again in the current recording
+     */
+    std::vector<uint64_t> m_toRecord;
 
 };
 
@@ -0,0 +1,80 @@
+/**
+ * @file OGL_StagingRing.cpp
+ * @author DM8AT
+ * @brief implement the staging ring for uploads to the GPU
+ * @version 0.1
+ * @date 2025-11-15
+ * 
+ * @copyright Copyright (c) 2025
+ * 
+ */
+//add the staging ring
+#include "OGL_StagingRing.h"
+//add the instance for the frame timeline
+#include "OGL_Instance.h"
+//add OpenGL
+#include "glad/glad.h"
+
+//use the OpenGL namespace
+using namespace GLGE::Graphic::Backend::OGL;
+
+StagingRing::Allocation StagingRing::allocate(uint64_t size) noexcept
+{
+    //data that is larger than the ring can't be staged
+    if ((size == 0) || (size > RING_SIZE)) {return {};}
+
+    //create the ring on first use
+    if (!s_buffer) {
+        glCreateBuffers(1, &s_buffer);
+        //store the flags to apply
+        GLenum flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glNamedBufferStorage(s_buffer, RING_SIZE, nullptr, flags);
+        s_mapped = glMapNamedBufferRange(s_buffer, 0, RING_SIZE, flags);
+    }
+
+    //free the memory of all frames the GPU finished
+    uint64_t completed = Instance::getCompletedFrame();
+    while (s_frames.size() && (s_frames.front().frame <= completed)) {
+        s_tail = s_frames.front().head;
+        s_frames.pop_front();
+    }
+    //if nothing is in flight, the ring is empty
+    if (s_frames.empty() && (s_tail == s_head)) {s_head = s_tail = 0;}
+
+    //align the start of the region
+    uint64_t start = ((s_head + ALIGNMENT - 1) / ALIGNMENT) * ALIGNMENT;
+    //regions never wrap around the end of the ring, so skip the rest of the ring if needed
+    if (((start % RING_SIZE) + size) > RING_SIZE) {start += RING_SIZE - (start % RING_SIZE);}
+    //check if the region would overwrite data the GPU may still read
+    if ((start + size - s_tail) > RING_SIZE) {return {};}
+
+    //hand out the region
+    s_head = start + size;
+    s_staged += size;
+    uint64_t offset = start % RING_SIZE;
+    return {s_buffer, offset, ((uint8_t*)s_mapped) + offset};
+}
+
+void StagingRing::endFrame(uint64_t frame) noexcept
+{
+    //store where the frame ended, if it used the ring at all
+    if (s_frames.empty() ? (s_head != s_tail) : (s_frames.back().head != s_head))
+    {s_frames.push_back({frame, s_head});}
+    //publish the statistics
+    s_lastStaged.store(s_staged, std::memory_order_relaxed);
+    s_staged = 0;
+}
+
+void StagingRing::clear() noexcept
+{
+    //delete the OpenGL buffer
+    if (s_buffer) {
+        glUnmapNamedBuffer(s_buffer);
+        glDeleteBuffers(1, &s_buffer);
+    }
+    s_buffer = 0;
+    s_mapped = nullptr;
+    //the ring is empty now
+    s_head = s_tail = 0;
+    s_frames.clear();
+}
@@ -0,0 +1,126 @@
+/**
+ * @file OGL_StagingRing.h
+ * @author DM8AT
+ * @brief define a persistently mapped ring buffer all uploads to the GPU are staged in
+ * @version 0.1
+ * @date 2025-11-15
+ * 
+ * @copyright Copyright (c) 2025
+ * 
+ */
+//header guard
+#ifndef _GLGE_GRAPHIC_BACKEND_API_IMPL_OGL_OGL_STAGING_RING_
+#define _GLGE_GRAPHIC_BACKEND_API_IMPL_OGL_OGL_STAGING_RING_
+
+//add all types
+#include "../../../../GLGE_Core/Types.h"
+
+//only available for C++
+#if __cplusplus
+
+//add a deque to store the end of each frame in the ring
+#include <deque>
+//add atomics for the statistics
+#include <atomic>
+
+//use the namespace GLGE::Graphic::Backend::OGL
+namespace GLGE::Graphic::Backend::OGL
+{
+
+/**
+ * @brief a single, persistently mapped ring buffer all uploads to the GPU are staged in
+ * 
+ * Data is copied to the ring on the CPU and then moved to its destination with a GPU copy.
+ * The memory of a frame is re-used as soon as the frame timeline of the instance says that the GPU finished the frame.
+ */
+class StagingRing
+{
+public:
+
+    /**
+     * @brief store a region of the ring that was handed out
+     */
+    struct Allocation {
+        //the OpenGL buffer of the ring
+        uint32_t buffer = 0;
+        //the offset of the region in the ring in bytes
+        uint64_t offset = 0;
+        //a pointer to the mapped memory of the region (nullptr if the allocation failed)
+        void* mapped = nullptr;
+    };
+
+    /**
+     * @brief the size of the ring in bytes
+     */
+    inline static constexpr uint64_t RING_SIZE = 32 * 1024 * 1024;
+    /**
+     * @brief the alignment of all regions in bytes
+     */
+    inline static constexpr uint64_t ALIGNMENT = 256;
+
+    /**
+     * @brief get a region of the ring to stage data in
+     * @warning this must be called from the thread that owns the OpenGL context
+     * 
+     * The region must be used by a GPU command before the next tick.
+     * 
+     * @param size the size of the region in bytes
+     * @return Allocation the new region, the mapped pointer is nullptr if the data does not fit into the ring right now
+     */
+    static Allocation allocate(uint64_t size) noexcept;
+
+    /**
+     * @brief mark the end of a frame
+     * @warning this must be called from the thread that owns the OpenGL context
+     * 
+     * @param frame the index of the frame that ended
+     */
+    static void endFrame(uint64_t frame) noexcept;
+
+    /**
+     * @brief delete the OpenGL buffer of the ring
+     * @warning this must be called from the thread that owns the OpenGL context
+     */
+    static void clear() noexcept;
+
+    /**
+     * @brief Get the amount of bytes that were staged during the last frame
+     * 
+     * @return uint64_t the amount of staged bytes
+     */
+    inline static uint64_t getStagedBytes() noexcept {return s_lastStaged.load(std::memory_order_relaxed);}
+
+protected:
+
+    /**
+     * @brief store where a frame ended in the ring
+     */
+    struct FrameMark {
+        //the index of the frame
+        uint64_t frame;
+        //the head of the ring at the end of the frame
+        uint64_t head;
+    };
+
+    //store the OpenGL buffer of the ring
+    inline static uint32_t s_buffer = 0;
+    //store a pointer to the mapped data of the ring
+    inline static void* s_mapped = nullptr;
+    //store the total amount of bytes that were handed out (the position in the ring is this modulo the ring size)
+    inline static uint64_t s_head = 0;
+    //store the total amount of bytes the GPU is done with
+    inline static uint64_t s_tail = 0;
+    //store where all frames the GPU did not finish yet end, oldest first
+    inline static std::deque<FrameMark> s_frames;
+    //store the amount of bytes staged during the current frame
+    inline static uint64_t s_staged = 0;
+    //store the amount of bytes staged during the last frame
+    inline static std::atomic_uint64_t s_lastStaged{0};
+
+};
+
+}
+
+#endif
+
+#endif
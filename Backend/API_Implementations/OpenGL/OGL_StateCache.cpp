@@ -0,0 +1,153 @@
+/**
+ * @file OGL_StateCache.cpp
+ * @author DM8AT
+ * @brief implement the shadow copy of the OpenGL state
+ * @version 0.1
+ * @date 2025-11-17
+ * 
+ * @copyright Copyright (c) 2025
+ * 
+ */
+//add the state cache
+#include "OGL_StateCache.h"
+//add OpenGL
+#include "glad/glad.h"
+
+//use the OpenGL namespace
+using namespace GLGE::Graphic::Backend::OGL;
+
+void StateCache::setDepthTest(bool enabled) noexcept
+{
+    //skip the call if the state is already set
+    if (s_depthTest == (uint32_t)enabled) {++s_eliminated; return;}
+    s_depthTest = enabled;
+    if (enabled) {glEnable(GL_DEPTH_TEST);} else {glDisable(GL_DEPTH_TEST);}
+}
+
+void StateCache::setDepthMask(bool enabled) noexcept
+{
+    //skip the call if the state is already set
+    if (s_depthMask == (uint32_t)enabled) {++s_eliminated; return;}
+    s_depthMask = enabled;
+    glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+}
+
+void StateCache::setDepthFunc(uint32_t func) noexcept
+{
+    //skip the call if the state is already set
+    if (s_depthFunc == func) {++s_eliminated; return;}
+    s_depthFunc = func;
+    glDepthFunc(func);
+}
+
+void StateCache::setCullFace(bool enabled) noexcept
+{
+    //skip the call if the state is already set
+    if (s_cullFace == (uint32_t)enabled) {++s_eliminated; return;}
+    s_cullFace = enabled;
+    if (enabled) {glEnable(GL_CULL_FACE);} else {glDisable(GL_CULL_FACE);}
+}
+
+void StateCache::bindVertexArray(uint32_t vao) noexcept
+{
+    //skip the call if the VAO is already bound
+    if (s_vao == vao) {++s_eliminated; return;}
+    s_vao = vao;
+    glBindVertexArray(vao);
+}
+
+void StateCache::useProgram(uint32_t program) noexcept
+{
+    //skip the call if the program is already in use
+    if (s_program == program) {++s_eliminated; return;}
+    s_program = program;
+    glUseProgram(program);
+}
+
+void StateCache::bindTextureUnit(uint32_t unit, uint32_t texture) noexcept
+{
+    //units outside of the cache are always bound
+    if (unit >= TEXTURE_UNIT_COUNT) {glBindTextureUnit(unit, texture); return;}
+    //skip the call if the texture is already bound
+    if (s_textures[unit] == texture) {++s_eliminated; return;}
+    s_textures[unit] = texture;
+    glBindTextureUnit(unit, texture);
+}
+
+StateCache::BufferBinding* StateCache::getBindings(uint32_t target) noexcept
+{
+    //select the bindings of the target
+    switch (target)
+    {
+    case GL_UNIFORM_BUFFER:
+        return s_uniformBuffers;
+    case GL_SHADER_STORAGE_BUFFER:
+        return s_storageBuffers;
+
+    default:
+        return nullptr;
+    }
+}
+
+void StateCache::bindBufferBase(uint32_t target, uint32_t index, uint32_t buffer) noexcept
+{
+    //bindings outside of the cache are always bound
+    BufferBinding* bindings = getBindings(target);
+    if (!bindings || (index >= BUFFER_BINDING_COUNT)) {glBindBufferBase(target, index, buffer); return;}
+    //skip the call if the whole buffer is already bound
+    BufferBinding& binding = bindings[index];
+    if ((binding.buffer == buffer) && (binding.offset == 0) && (binding.size == 0)) {++s_eliminated; return;}
+    binding = {buffer, 0, 0};
+    glBindBufferBase(target, index, buffer);
+}
+
+void StateCache::bindBufferRange(uint32_t target, uint32_t index, uint32_t buffer, uint64_t offset, uint64_t size) noexcept
+{
+    //bindings outside of the cache are always bound
+    BufferBinding* bindings = getBindings(target);
+    if (!bindings || (index >= BUFFER_BINDING_COUNT)) {glBindBufferRange(target, index, buffer, offset, size); return;}
+    //skip the call if the range is already bound
+    BufferBinding& binding = bindings[index];
+    if ((binding.buffer == buffer) && (binding.offset == offset) && (binding.size == size)) {++s_eliminated; return;}
+    binding = {buffer, offset, size};
+    glBindBufferRange(target, index, buffer, offset, size);
+}
+
+void StateCache::vertexArrayVertexBuffer(uint32_t vao, uint32_t buffer, uint32_t stride) noexcept
+{
+    //skip the call if the buffer is already attached
+    GeometryBinding& binding = s_geometry[vao];
+    if ((binding.vertexBuffer == buffer) && (binding.stride == stride)) {++s_eliminated; return;}
+    binding.vertexBuffer = buffer;
+    binding.stride = stride;
+    glVertexArrayVertexBuffer(vao, 0, buffer, 0, stride);
+}
+
+void StateCache::vertexArrayElementBuffer(uint32_t vao, uint32_t buffer) noexcept
+{
+    //skip the call if the buffer is already attached
+    GeometryBinding& binding = s_geometry[vao];
+    if (binding.indexBuffer == buffer) {++s_eliminated; return;}
+    binding.indexBuffer = buffer;
+    glVertexArrayElementBuffer(vao, buffer);
+}
+
+void StateCache::invalidate() noexcept
+{
+    //mark all state as unknown
+    s_depthTest = s_depthMask = s_depthFunc = s_cullFace = s_vao = s_program = UNKNOWN;
+    for (uint32_t i = 0; i < TEXTURE_UNIT_COUNT; ++i) {s_textures[i] = UNKNOWN;}
+    for (uint32_t i = 0; i < BUFFER_BINDING_COUNT; ++i) {
+        s_uniformBuffers[i] = {UNKNOWN, 0, 0};
+        s_storageBuffers[i] = {UNKNOWN, 0, 0};
+    }
+    //buffer and vertex array names may be re-used after they were deleted, so the attachments are forgotten too
+    s_geometry.clear();
+}
+
+void StateCache::endFrame() noexcept
+{
+    //publish the statistics
+    s_lastEliminated.store(s_eliminated, std::memory_order_relaxed);
+    s_eliminated = 0;
+}
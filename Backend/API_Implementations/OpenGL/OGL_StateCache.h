@@ -0,0 +1,223 @@
+/**
+ * @file OGL_StateCache.h
+ * @author DM8AT
+ * @brief define a shadow copy of the OpenGL state to filter redundant state changes
+ * @version 0.1
+ * @date 2025-11-17
+ * 
+ * @copyright Copyright (c) 2025
+ * 
+ */
+//header guard
+#ifndef _GLGE_GRAPHIC_BACKEND_API_IMPL_OGL_OGL_STATE_CACHE_
+#define _GLGE_GRAPHIC_BACKEND_API_IMPL_OGL_OGL_STATE_CACHE_
+
+//add all types
+#include "../../../../GLGE_Core/Types.h"
+
+//only available for C++
+#if __cplusplus
+
+//add atomics for the statistics
+#include <atomic>
+//add maps for the state of each vertex array object
+#include <unordered_map>
+
+//use the namespace GLGE::Graphic::Backend::OGL
+namespace GLGE::Graphic::Backend::OGL
+{
+
+/**
+ * @brief a shadow copy of the OpenGL state the commands change
+ * 
+ * Each function only calls OpenGL if the requested state differs from the cached one.
+ * All functions must be called from the thread that owns the OpenGL context.
+ * The cache must be invalidated whenever OpenGL state is changed without it, for example by custom commands.
+ */
+class StateCache
+{
+public:
+
+    /**
+     * @brief the amount of texture units that are cached, higher units are always bound
+     */
+    inline static constexpr uint32_t TEXTURE_UNIT_COUNT = 32;
+    /**
+     * @brief the amount of uniform and shader storage buffer bindings that are cached, higher bindings are always bound
+     */
+    inline static constexpr uint32_t BUFFER_BINDING_COUNT = 32;
+
+    /**
+     * @brief enable or disable depth testing
+     * 
+     * @param enabled true : depth testing is enabled | false : depth testing is disabled
+     */
+    static void setDepthTest(bool enabled) noexcept;
+
+    /**
+     * @brief enable or disable writing to the depth buffer
+     * 
+     * @param enabled true : depth writing is enabled | false : depth writing is disabled
+     */
+    static void setDepthMask(bool enabled) noexcept;
+
+    /**
+     * @brief set the function used for depth testing
+     * 
+     * @param func the OpenGL depth function
+     */
+    static void setDepthFunc(uint32_t func) noexcept;
+
+    /**
+     * @brief enable or disable back face culling
+     * 
+     * @param enabled true : culling is enabled | false : culling is disabled
+     */
+    static void setCullFace(bool enabled) noexcept;
+
+    /**
+     * @brief bind a vertex array object
+     * 
+     * @param vao the name of the vertex array object to bind
+     */
+    static void bindVertexArray(uint32_t vao) noexcept;
+
+    /**
+     * @brief bind a shader program
+     * 
+     * @param program the name of the shader program to use
+     */
+    static void useProgram(uint32_t program) noexcept;
+
+    /**
+     * @brief bind a texture to a texture unit
+     * 
+     * @param unit the texture unit to bind to
+     * @param texture the name of the texture to bind
+     */
+    static void bindTextureUnit(uint32_t unit, uint32_t texture) noexcept;
+
+    /**
+     * @brief bind a whole buffer to an indexed uniform or shader storage buffer binding
+     * 
+     * @param target either GL_UNIFORM_BUFFER or GL_SHADER_STORAGE_BUFFER
+     * @param index the index of the binding
+     * @param buffer the name of the buffer to bind
+     */
+    static void bindBufferBase(uint32_t target, uint32_t index, uint32_t buffer) noexcept;
+
+    /**
+     * @brief bind a range of a buffer to an indexed uniform or shader storage buffer binding
+     * 
+     * @param target either GL_UNIFORM_BUFFER or GL_SHADER_STORAGE_BUFFER
+     * @param index the index of the binding
+     * @param buffer the name of the buffer to bind
+     * @param offset the offset of the range in bytes
+     * @param size the size of the range in bytes
+     */
+    static void bindBufferRange(uint32_t target, uint32_t index, uint32_t buffer, uint64_t offset, uint64_t size) noexcept;
+
+    /**
+     * @brief attach a vertex buffer to the first vertex buffer binding of a vertex array object
+     * 
+     * @param vao the name of the vertex array object
+     * @param buffer the name of the vertex buffer to attach
+     * @param stride the distance between two vertices in bytes
+     */
+    static void vertexArrayVertexBuffer(uint32_t vao, uint32_t buffer, uint32_t stride) noexcept;
+
+    /**
+     * @brief attach an index buffer to a vertex array object
+     * 
+     * @param vao the name of the vertex array object
+     * @param buffer the name of the index buffer to attach
+     */
+    static void vertexArrayElementBuffer(uint32_t vao, uint32_t buffer) noexcept;
+
+    /**
+     * @brief forget all cached state, so the next call of each function reaches OpenGL
+     */
+    static void invalidate() noexcept;
+
+    /**
+     * @brief mark the end of a frame and publish the statistics of the frame
+     */
+    static void endFrame() noexcept;
+
+    /**
+     * @brief Get the amount of OpenGL calls that were filtered during the last frame
+     * 
+     * @return uint64_t the amount of eliminated OpenGL calls
+     */
+    inline static uint64_t getEliminatedCalls() noexcept {return s_lastEliminated.load(std::memory_order_relaxed);}
+
+protected:
+
+    /**
+     * @brief store the cached state of a single indexed buffer binding
+     */
+    struct BufferBinding {
+        //the name of the bound buffer
+        uint32_t buffer;
+        //the offset of the bound range in bytes
+        uint64_t offset;
+        //the size of the bound range in bytes (0 means the whole buffer is bound)
+        uint64_t size;
+    };
+
+    //store the value used for unknown state, no valid state uses it
+    inline static constexpr uint32_t UNKNOWN = UINT32_MAX;
+
+    /**
+     * @brief store the cached buffers attached to a single vertex array object
+     */
+    struct GeometryBinding {
+        //the name of the attached vertex buffer
+        uint32_t vertexBuffer = UNKNOWN;
+        //the stride of the attached vertex buffer in bytes
+        uint32_t stride = UNKNOWN;
+        //the name of the attached index buffer
+        uint32_t indexBuffer = UNKNOWN;
+    };
+
+    /**
+     * @brief get the cached indexed bindings of a buffer target
+     * 
+     * @param target either GL_UNIFORM_BUFFER or GL_SHADER_STORAGE_BUFFER
+     * @return BufferBinding* a pointer to the cached bindings or nullptr if the target is not cached
+     */
+    static BufferBinding* getBindings(uint32_t target) noexcept;
+
+    //store the state of the depth test
+    inline static uint32_t s_depthTest = UNKNOWN;
+    //store the state of the depth mask
+    inline static uint32_t s_depthMask = UNKNOWN;
+    //store the depth function
+    inline static uint32_t s_depthFunc = UNKNOWN;
+    //store the state of back face culling
+    inline static uint32_t s_cullFace = UNKNOWN;
+    //store the bound vertex array object
+    inline static uint32_t s_vao = UNKNOWN;
+    //store the used shader program
+    inline static uint32_t s_program = UNKNOWN;
+    //store the textures bound to each unit (nothing is bound in a new context)
+    inline static uint32_t s_textures[TEXTURE_UNIT_COUNT];
+    //store the uniform buffer bindings
+    inline static BufferBinding s_uniformBuffers[BUFFER_BINDING_COUNT];
+    //store the shader storage buffer bindings
+    inline static BufferBinding s_storageBuffers[BUFFER_BINDING_COUNT];
+    //store the buffers attached to each vertex array object
+    inline static std::unordered_map<uint32_t, GeometryBinding> s_geometry;
+
+    //store the amount of eliminated calls of the current frame
+    inline static uint64_t s_eliminated = 0;
+    //store the amount of eliminated calls of the last frame
+    inline static std::atomic_uint64_t s_lastEliminated{0};
+
+};
+
+}
+
+#endif
+
+#endif
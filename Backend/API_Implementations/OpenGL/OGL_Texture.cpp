@@ -13,8 +13,12 @@
 #include "OGL_Texture.h"
 //add the OpenGL command buffer
 #include "OGL_CommandBuffer.h"
+//add the staging ring for uploads
+#include "OGL_StagingRing.h"
 //access the frontend texture
 #include "../../../Frontend/Texture.h"
+//add memcpy
+#include <cstring>
 //add OpenGL
 #include "glad/glad.h"
 
@@ -187,6 +191,58 @@ static GLenum getGLTilingMode(TextureTileMode tiling) noexcept {
     }
 }
 
+/**
+ * @brief upload the data of a single sample texture through the staging ring
+ * 
+ * If the staging ring is full, the data is uploaded from the client memory directly. 
+ * 
+ * @param tex the OpenGL texture to upload to
+ * @param width the width of the texture in pixels
+ * @param height the height of the texture in pixels
+ * @param layout the OpenGL layout of the data
+ * @param type the OpenGL type of a single channel
+ * @param data a pointer to the data to upload or nullptr to fill the texture with zeros
+ */
+static void uploadTexture(uint32_t tex, uint32_t width, uint32_t height, GLenum layout, GLenum type, const void* data) noexcept
+{
+    //compute the size of a single pixel
+    uint64_t pixelSize = 4;
+    switch (layout)
+    {
+    case GL_RED:  pixelSize = 1; break;
+    case GL_RG:   pixelSize = 2; break;
+    case GL_RGB:  pixelSize = 3; break;
+    case GL_RGBA: pixelSize = 4; break;
+    default:      pixelSize = 4; break;
+    }
+    pixelSize *= (type == GL_FLOAT) ? sizeof(float) : sizeof(uint8_t);
+    uint64_t size = uint64_t(width) * uint64_t(height) * pixelSize;
+
+    //the rows are tightly packed, but OpenGL expects rows to start at 4 byte boundaries by default
+    //that breaks RGB and single channel textures with widths that are not a multiple of 4
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    //stage the data
+    GLGE::Graphic::Backend::OGL::StagingRing::Allocation stage = GLGE::Graphic::Backend::OGL::StagingRing::allocate(size);
+    if (stage.mapped) {
+        //copy the data or fill the region with zeros if no data was supplied
+        if (data) {memcpy(stage.mapped, data, size);}
+        else {memset(stage.mapped, 0, size);}
+        //the pixel unpack buffer turns the data pointer into an offset into the ring
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, stage.buffer);
+        glTextureSubImage2D(tex, 0, 0,0, width, height, layout, type, (const void*)(uintptr_t)stage.offset);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    } else if (data) {
+        //upload from the client memory
+        glTextureSubImage2D(tex, 0, 0,0, width, height, layout, type, data);
+    } else {
+        //no data means that the texture is cleared to zero
+        glClearTexImage(tex, 0, layout, type, nullptr);
+    }
+    //restore the default alignment for all other uploads
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
 GLGE::Graphic::Backend::OGL::Texture::Texture(::Texture* tex, FilterMode filterMode, float anisotropy, TextureMultiSample samples, TextureTileMode tiling)
  : API::Texture(tex, filterMode, anisotropy, samples, tiling) 
 {
@@ -322,18 +378,14 @@ void GLGE::Graphic::Backend::OGL::Texture::recreate() noexcept
             //respect multi-sampling upload
             if (m_samples == GLGE_TEXTURE_SAMPLE_X1) {
                 //can re-upload just the data, no re-creation needed
-                glTextureSubImage2D(m_glTex, 0, 0,0, m_texture->getData().extent.x, m_texture->getData().extent.y, getGLTextureLayout(m_texture->getData()), 
-                                    m_texture->getData().isHDR ? GL_FLOAT : GL_UNSIGNED_BYTE, *((void**)&m_texture->getData().data));
-            } else {
-                
+                uploadTexture(m_glTex, m_texture->getData().extent.x, m_texture->getData().extent.y, getGLTextureLayout(m_texture->getData()), 
+                              m_texture->getData().isHDR ? GL_FLOAT : GL_UNSIGNED_BYTE, *((void**)&m_texture->getData().data));
+                return;
             }
         }
-        else
-        {
-            //data re-creation needed
-            //first, clean up
-            glDeleteTextures(1, &m_glTex);
-        }   
+        //data re-creation needed
+        //first, clean up
+        glDeleteTextures(1, &m_glTex);
     }
 
     //create the texture
@@ -375,53 +427,8 @@ void GLGE::Graphic::Backend::OGL::Texture::recreate() noexcept
     else
     {
         //Color texture upload
-        if (!hasUserData)
-        {
-            //allocate zeroed data if user did not supply any
-            const uint32_t w = m_texture->getData().extent.x;
-            const uint32_t h = m_texture->getData().extent.y;
-
-            //Compute pixel size
-            uint32_t pixelSize = 1;
-            switch (layout)
-            {
-            case GL_RED:  pixelSize = 1; break;
-            case GL_RG:   pixelSize = 2; break;
-            case GL_RGB:  pixelSize = 3; break;
-            case GL_RGBA: pixelSize = 4; break;
-            default:      pixelSize = 4; break;
-            }
-
-            if (m_texture->getData().isHDR)
-                pixelSize *= sizeof(float);
-            else
-                pixelSize *= sizeof(uint8_t);
-
-            const size_t dataSize = size_t(w) * size_t(h) * pixelSize;
-
-            void* zero = calloc(1, dataSize);   //zero-initialized
-
-            glTextureSubImage2D(
-                m_glTex, 0, 0,0, w, h,
-                layout,
-                type,
-                zero
-            );
-
-            free(zero);
-        }
-        else
-        {
-            //Upload user data
-            glTextureSubImage2D(
-                m_glTex, 0, 0,0, 
-                m_texture->getData().extent.x, 
-                m_texture->getData().extent.y, 
-                layout, 
-                type, 
-                dataPtr
-            );
-        }
+        //if the user did not supply any data, the texture is filled with zeros
+        uploadTexture(m_glTex, m_texture->getData().extent.x, m_texture->getData().extent.y, layout, type, hasUserData ? dataPtr : nullptr);
     }
 
     //for multi sample textures, the setup is done here
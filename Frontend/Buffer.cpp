@@ -46,6 +46,16 @@ void Buffer::write(void* data, uint64_t offset, uint64_t size) noexcept {
     ((GLGE::Graphic::Backend::API::CycleBuffer*)m_buff)->write(data, size, offset);
 }
 
+void* Buffer::map(uint64_t offset, uint64_t size) noexcept {
+    //map the region
+    return ((GLGE::Graphic::Backend::API::CycleBuffer*)m_buff)->map(offset, size);
+}
+
+void Buffer::unmap(uint64_t offset, uint64_t size) noexcept {
+    //publish the changes
+    ((GLGE::Graphic::Backend::API::CycleBuffer*)m_buff)->unmap(offset, size);
+}
+
 void Buffer::resize(uint64_t size) noexcept {
     //change the size of the buffer
     ((GLGE::Graphic::Backend::API::CycleBuffer*)m_buff)->resize(size);
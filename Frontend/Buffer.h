@@ -97,6 +97,28 @@ public:
      */
     void write(void* data, uint64_t offset, uint64_t size) noexcept;
 
+    /**
+     * @brief get direct write access to a region of the buffer
+     * 
+     * The region can be written in place, all changes are published with a single call to `unmap`. 
+     * 
+     * @warning each successful map must be followed by exactly one unmap of the same region. The buffer can't be updated for rendering until then. 
+     * @warning the mapping thread must not set or resize the buffer before the unmap, as it would wait for its own mapping. 
+     * 
+     * @param offset the offset into the buffer to map
+     * @param size the size of the region in bytes
+     * @return void* a pointer to the start of the region or nullptr if the region is out of bounds (then no unmap is needed)
+     */
+    void* map(uint64_t offset, uint64_t size) noexcept;
+
+    /**
+     * @brief finish writing to a mapped region and publish the changes
+     * 
+     * @param offset the offset of the mapped region
+     * @param size the size of the mapped region in bytes
+     */
+    void unmap(uint64_t offset, uint64_t size) noexcept;
+
     /**
      * @brief change the size of the buffer
      * 
@@ -111,7 +133,7 @@ protected:
     //store the type of the buffer
     BufferType m_type = GLGE_BUFFER_TYPE_SHADER_STORAGE;
     //store the backend buffer
-    uint8_t m_buffStorage[96];
+    uint8_t m_buffStorage[72];
     //store a pointer to the buffer (null means uninitialized)
     void* m_buff = nullptr;
 
@@ -84,6 +84,32 @@ public:
      */
     inline Buffer* getBuffer(uint8_t idx) const noexcept {return m_buffers[idx];}
 
+    /**
+     * @brief Set if the shader only reads from a specific buffer
+     * 
+     * Shader storage buffers are expected to be written by the shader unless they are marked as read only, uniform buffers are always read only. 
+     * This is used by the automatic memory barriers of render pipelines to skip barriers that are not needed. 
+     * 
+     * @warning the index is not checked before accessing the buffer array
+     * 
+     * @param idx the index of the buffer
+     * @param readOnly true : the shader only reads from the buffer | false : the shader may write to the buffer
+     */
+    inline void setBufferReadOnly(uint8_t idx, bool readOnly) noexcept
+    {m_readOnly = readOnly ? (m_readOnly | (1u << idx)) : (m_readOnly & ~(1u << idx));}
+
+    /**
+     * @brief Get if the shader may write to a specific buffer
+     * 
+     * @warning the index is not checked before accessing the buffer array
+     * 
+     * @param idx the index of the buffer to quarry
+     * @return true : the shader may write to the buffer | false : the shader only reads from the buffer or the slot is skipped
+     */
+    inline bool isBufferWritten(uint8_t idx) const noexcept
+    {return !(m_readOnly & (1u << idx)) && ((((uint64_t)m_buffers[idx]) >> 8) != (GLGE_SKIP_SLOT_MARKER >> 8)) && 
+            (m_buffers[idx]->getType() == GLGE_BUFFER_TYPE_SHADER_STORAGE);}
+
     /**
      * @brief Get the amount of textures used by the compute object
      * 
@@ -109,6 +135,8 @@ protected:
     Buffer* m_buffers[GLGE_MAX_COMPUTE_SHADER_COMBINED_BUFFERS] = { nullptr };
     //store how many buffers are used
     uint8_t m_bufferCount = 0;
+    //store a bit for each buffer the shader only reads from
+    uint32_t m_readOnly = 0;
     //store the textures
     Texture* m_textures[GLGE_MAX_COMPUTE_SHADER_TEXTURES] = { nullptr };
     //store how many textures are used
@@ -175,6 +175,32 @@ public:
      */
     inline const ::Buffer** getUsedBuffers() const noexcept {return (const ::Buffer**)m_buffers;}
 
+    /**
+     * @brief Set if the shaders of the material only read from a specific buffer
+     * 
+     * Shader storage buffers are expected to be written by the shaders unless they are marked as read only, uniform buffers are always read only. 
+     * This is used by the automatic memory barriers of render pipelines to skip barriers that are not needed. 
+     * 
+     * @warning the index is not checked before accessing the buffer array
+     * 
+     * @param idx the index of the buffer
+     * @param readOnly true : the shaders only read from the buffer | false : the shaders may write to the buffer
+     */
+    inline void setBufferReadOnly(uint8_t idx, bool readOnly) noexcept
+    {m_readOnly = readOnly ? (m_readOnly | (1ull << idx)) : (m_readOnly & ~(1ull << idx));}
+
+    /**
+     * @brief Get if the shaders of the material may write to a specific buffer
+     * 
+     * @warning the index is not checked before accessing the buffer array
+     * 
+     * @param idx the index of the buffer to quarry
+     * @return true : the shaders may write to the buffer | false : the shaders only read from the buffer or the slot is skipped
+     */
+    inline bool isBufferWritten(uint8_t idx) const noexcept
+    {return !(m_readOnly & (1ull << idx)) && ((((uint64_t)m_buffers[idx]) >> 8) != (GLGE_SKIP_SLOT_MARKER >> 8)) && 
+            (m_buffers[idx]->getType() == GLGE_BUFFER_TYPE_SHADER_STORAGE);}
+
     /**
      * @brief Get the Vertex Layout of the material
      * 
@@ -220,6 +246,8 @@ protected:
     ::Buffer* m_buffers[GLGE_MAX_MATERIAL_BUFFER_BINDING] = { nullptr };
     //store the amount of bound buffers
     uint8_t m_usedBuffers = 0;
+    //store a bit for each buffer the shaders only read from
+    uint64_t m_readOnly = 0;
     //store the vertex layout for the material
     VertexLayout m_layout;
     //store the backend material
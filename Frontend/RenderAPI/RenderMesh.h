@@ -85,7 +85,7 @@ protected:
     //store a unique id
     uint64_t m_uid = 0;
     //store the data for the backend implementation (it is fully opaque)
-    uint8_t m_impl[56]{0};
+    uint8_t m_impl[72]{0};
     //store a pointer to the backend implementation 
     void* m_backend = nullptr;
 
@@ -35,6 +35,9 @@ RenderPipeline::RenderPipeline(const std::vector<std::pair<String, RenderPipelin
         m_stages.push_back(value);
     }
 
+    //all stages start at the first version
+    m_stageVersions = std::vector<std::atomic_uint32_t>(m_stages.size());
+
     //add the backend API
     initializeAPI();
 }
@@ -58,14 +61,24 @@ RenderPipeline::RenderPipeline(const RenderPipelineStageNamed* namedStages, size
         m_stages.push_back(value);
     }
 
+    //all stages start at the first version
+    m_stageVersions = std::vector<std::atomic_uint32_t>(m_stages.size());
+
     //add the backend API
     initializeAPI();
 }
 
 RenderPipeline::~RenderPipeline() noexcept
 {
-    //make sure to join back any lingering threads
-    if (m_thread.joinable()) {m_thread.join();}
+    //stop the recording thread, a running recording is finished first
+    if (m_thread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(m_mut);
+            m_stopRecording = true;
+        }
+        m_cond.notify_all();
+        m_thread.join();
+    }
     //only delete if the API is set up
     if (m_api)
     {
@@ -86,19 +99,63 @@ RenderPipeline::~RenderPipeline() noexcept
 
 void RenderPipeline::record() noexcept
 {
-    //if any recording is lingering, re-join it
-    if (m_thread.joinable()) {m_thread.join();}
-    //lock the recording
-    updateRecordingState(true);
-    //start the async recording
-    m_thread = std::thread(&RenderPipeline::asyncRecord, this);
+    //the recording thread is only created once
+    if (!m_thread.joinable()) {m_thread = std::thread(&RenderPipeline::recordLoop, this);}
+
+    {
+        //thread safety
+        std::unique_lock<std::mutex> lock(m_mut);
+        if ((m_requested - m_played) >= m_framesInFlight) {
+            //all frames are in flight, so the newest frame is recorded again once its recording finished
+            m_cond.wait(lock, [this]{ return m_recorded == m_requested;});
+            m_recorded = m_requested - 1;
+        } else {
+            //else, request a new frame
+            ++m_requested;
+        }
+        //store when the recording was requested
+        m_recordStart[(m_requested - 1) % GLGE_MAX_FRAMES_IN_FLIGHT] = std::chrono::steady_clock::now();
+        //copy the scenes now, the recording thread can't start the slot while the lock is held
+        ((GLGE::Graphic::Backend::API::RenderPipeline*)m_api)->snapshot((m_requested - 1) % GLGE_MAX_FRAMES_IN_FLIGHT);
+    }
+    //wake up the recording thread
+    m_cond.notify_all();
+}
+
+void RenderPipeline::invalidateStage(const String& name) noexcept
+{
+    //find the stage
+    auto pos = m_keyMap.find(name);
+    //sanity check
+    GLGE_DEBUG_ASSERT("Invalidating a stage that does not exist in the render pipeline", pos == m_keyMap.end());
+    if (pos == m_keyMap.end()) {return;}
+    //a new version forces the stage to be recorded again
+    m_stageVersions[pos->second].fetch_add(1, std::memory_order_acq_rel);
 }
 
 void RenderPipeline::waitForRecording() noexcept {
-    //wait for the recording state
-    waitForRecordingState(false);
-    //if the thread can be joined, join it
-    if (m_thread.joinable()) {m_thread.join();}
+    //wait until all requested frames are recorded
+    std::unique_lock<std::mutex> lock(m_mut);
+    m_cond.wait(lock, [this]{ return m_recorded == m_requested;});
+}
+
+void RenderPipeline::setFramesInFlight(uint8_t frames) noexcept {
+    //thread safety
+    std::unique_lock<std::mutex> lock(m_mut);
+    //clamp the amount to the available frame slots
+    m_framesInFlight = (frames == 0) ? 1 : ((frames > GLGE_MAX_FRAMES_IN_FLIGHT) ? GLGE_MAX_FRAMES_IN_FLIGHT : frames);
+}
+
+uint64_t RenderPipeline::getRemovedCommands() const noexcept
+{
+    //the statistics are kept by the backend
+    return m_api ? ((GLGE::Graphic::Backend::API::RenderPipeline*)m_api)->getRemovedCommands() : 0;
+}
+
+uint64_t RenderPipeline::getMergedCommands() const noexcept
+{
+    //the statistics are kept by the backend
+    return m_api ? ((GLGE::Graphic::Backend::API::RenderPipeline*)m_api)->getMergedCommands() : 0;
 }
 
 void RenderPipeline::play() noexcept
@@ -111,10 +168,38 @@ void RenderPipeline::play() noexcept
     //store the tick start time
     auto start = std::chrono::steady_clock::now();
 
-    //make sure the the recording is not running
-    waitForRecordingState(false);
+    //select the frame to play
+    uint64_t frame = 0;
+    bool advance = false;
+    bool playing = false;
+    {
+        //thread safety
+        std::unique_lock<std::mutex> lock(m_mut);
+        if ((m_requested - m_played) >= m_framesInFlight) {
+            //all frames are in flight, so play the oldest one once it is recorded
+            frame = m_played;
+            advance = true;
+            m_cond.wait(lock, [this, frame]{ return m_recorded > frame;});
+        } else {
+            //else, play the last played frame again (if there is any)
+            frame = m_played - 1;
+        }
+        //the recording thread must not record to the slot while it is played
+        playing = advance || (m_played > 0);
+        m_playing = playing;
+        m_playingFrame = frame;
+    }
     //just play back the API pipeline
-    ((GLGE::Graphic::Backend::API::RenderPipeline*)m_api)->play();
+    if (playing) {
+        ((GLGE::Graphic::Backend::API::RenderPipeline*)m_api)->play(frame % GLGE_MAX_FRAMES_IN_FLIGHT);
+        //the frame is done
+        {
+            std::lock_guard<std::mutex> lock(m_mut);
+            m_played += advance ? 1 : 0;
+            m_playing = false;
+        }
+        m_cond.notify_all();
+    }
 
     //compute the requested iteration rate
     std::chrono::nanoseconds iterRate((int64_t)(1E9 / (double)m_ips));
@@ -136,37 +221,41 @@ void RenderPipeline::play() noexcept
     }
 }
 
-void RenderPipeline::updateRecordingState(bool state) noexcept
+void RenderPipeline::recordLoop() noexcept
 {
-    //lock the mutex
-    std::lock_guard<std::mutex> lock(m_mut);
-    //and set the recording to true
-    m_isRecording = state;
-    //notify the change
-    m_cond.notify_one();
-}
-
-void RenderPipeline::waitForRecordingState(bool state) noexcept
-{
-    //lock the mutex to sync the conditional variable
-    std::unique_lock<std::mutex> lock(m_mut);
-
-    //only waite if the state is mismatched
-    if (m_isRecording != state)
-    {
-        //wait for the conditional variable to be in the correct state
-        m_cond.wait(lock, [this, state]{ return (m_isRecording.load() == state);});
+    while (true) {
+        //the frame to record
+        uint64_t frame = 0;
+        {
+            //wait until a recording is requested and its slot is not played or the thread should stop
+            std::unique_lock<std::mutex> lock(m_mut);
+            m_cond.wait(lock, [this]{ 
+                return ((m_recorded < m_requested) && 
+                        !(m_playing && ((m_recorded % GLGE_MAX_FRAMES_IN_FLIGHT) == (m_playingFrame % GLGE_MAX_FRAMES_IN_FLIGHT)))) || 
+                       (m_stopRecording && (m_recorded == m_requested));
+            });
+            //a requested recording is always finished, so nobody waits forever
+            if (m_recorded == m_requested) {return;}
+            frame = m_recorded;
+        }
+        {
+            //the geometry must not be compacted while recording
+            std::shared_lock<std::shared_mutex> recordLock(GLGE::Graphic::Backend::API::RenderPipeline::s_recordMtx);
+            //just record the API pipeline
+            ((GLGE::Graphic::Backend::API::RenderPipeline*)m_api)->record(frame % GLGE_MAX_FRAMES_IN_FLIGHT);
+        }
+        {
+            //done
+            std::lock_guard<std::mutex> lock(m_mut);
+            //store how long the recording took
+            m_recordTime.store(std::chrono::duration<double>(std::chrono::steady_clock::now() - m_recordStart[frame % GLGE_MAX_FRAMES_IN_FLIGHT]).count(), 
+                               std::memory_order_relaxed);
+            m_recorded = frame + 1;
+        }
+        m_cond.notify_all();
     }
 }
 
-void RenderPipeline::asyncRecord() noexcept
-{
-    //just record the API pipeline
-    ((GLGE::Graphic::Backend::API::RenderPipeline*)m_api)->record();
-    //done
-    updateRecordingState(false);
-}
-
 void RenderPipeline::initializeAPI() noexcept
 {
     //switch over the used API
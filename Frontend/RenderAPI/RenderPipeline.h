@@ -56,6 +56,8 @@ typedef struct s_BlitTargetInfo {
 
 //define a value that represents unlimited iterations per second for a render pipeline
 #define GLGE_UNLIMITED 0
+//define the maximum amount of frames a render pipeline may record ahead of the played frame
+#define GLGE_MAX_FRAMES_IN_FLIGHT 3
 
 /**
  * @brief define all types of stages a render pipeline may include
@@ -82,7 +84,9 @@ typedef enum e_RenderPipelineStageType {
      */
     GLGE_RENDER_PIPELINE_DISPATCH_COMPUTE,
     /**
-     * @brief make sure the memory is fully up to date
+     * @brief make sure writes of shaders are visible to the following stages
+     * 
+     * The barrier data selects which accesses the writes are made visible to
      */
     GLGE_RENDER_PIPELINE_MEMORY_BARRIER,
     /**
@@ -95,6 +99,32 @@ typedef enum e_RenderPipelineStageType {
     GLGE_RENDER_PIPELINE_CLEAR
 } RenderPipelineStageType;
 
+/**
+ * @brief define the types of memory accesses a memory barrier makes writes of shaders visible to
+ * 
+ * The values can be combined. A barrier without any bits waits for all accesses. 
+ */
+typedef enum e_BarrierBits {
+    //make writes visible to all accesses
+    GLGE_BARRIER_ALL = 0,
+    //make writes visible to vertex data reads
+    GLGE_BARRIER_VERTEX_DATA = 1 << 0,
+    //make writes visible to index data reads
+    GLGE_BARRIER_INDEX_DATA = 1 << 1,
+    //make writes visible to uniform buffer reads
+    GLGE_BARRIER_UNIFORM_BUFFER = 1 << 2,
+    //make writes visible to shader storage buffer accesses
+    GLGE_BARRIER_STORAGE_BUFFER = 1 << 3,
+    //make writes visible to texture samples
+    GLGE_BARRIER_TEXTURE_FETCH = 1 << 4,
+    //make writes visible to indirect draw and dispatch commands
+    GLGE_BARRIER_INDIRECT_COMMAND = 1 << 5,
+    //make writes visible to framebuffer reads and writes
+    GLGE_BARRIER_FRAMEBUFFER = 1 << 6,
+    //make writes visible to buffer uploads and copies
+    GLGE_BARRIER_BUFFER_UPDATE = 1 << 7
+} BarrierBits;
+
 //define an enum to map what to clear to colors
 typedef enum e_ClearType {
     //clear a color attachment
@@ -160,6 +190,11 @@ typedef union u_RenderPipelineStageData {
         bool copyDepth;
         bool copyStencil;
     } blit;
+    //store the data needed for a memory barrier
+    struct Barrier {
+        //store a combination of barrier bits (GLGE_BARRIER_ALL if 0)
+        uint32_t barriers;
+    } barrier;
     //store the data needed to clear a framebuffer
     struct Clear {
         //a pointer to the framebuffer to clear
@@ -264,6 +299,100 @@ public:
      */
     inline bool containsStage(const String& name) const noexcept {return m_keyMap.find(name) != m_keyMap.end();}
 
+    /**
+     * @brief force a specific stage to be recorded again
+     * 
+     * Stages are only recorded again if their data changes, so this must be called if a resource the stage uses was replaced without changing the stage data. 
+     * 
+     * @param name the name of the stage to record again
+     */
+    void invalidateStage(const String& name) noexcept;
+
+    /**
+     * @brief force all stages to be recorded again
+     */
+    inline void invalidateStages() noexcept
+    {for (std::atomic_uint32_t& version : m_stageVersions) {version.fetch_add(1, std::memory_order_acq_rel);}}
+
+    /**
+     * @brief Get the version of a stage, it changes each time the stage is invalidated
+     * 
+     * @param index the index of the stage
+     * @return uint32_t the version of the stage
+     */
+    inline uint32_t getStageVersion(uint64_t index) const noexcept {return m_stageVersions[index].load(std::memory_order_acquire);}
+
+    /**
+     * @brief Set if the draws of each frame are sorted to reduce state changes
+     * 
+     * Sorting groups draws by shader, material and geometry pages, so draws of consecutive stages are sorted together. 
+     * It never moves a draw across a clear, blit, barrier, dispatch or custom command or a change of the render target, 
+     * and draws with identical state keep their recorded order. 
+     * All stages are recorded again after the setting changed. 
+     * 
+     * @param sort true : draws are sorted | false : draws are played in the order they were recorded
+     */
+    inline void setDrawSorting(bool sort) noexcept {m_sortDraws.store(sort, std::memory_order_relaxed); invalidateStages();}
+
+    /**
+     * @brief Get if the draws of each frame are sorted to reduce state changes
+     * 
+     * @return true : draws are sorted | false : draws are played in the order they were recorded
+     */
+    inline bool getDrawSorting() const noexcept {return m_sortDraws.load(std::memory_order_relaxed);}
+
+    /**
+     * @brief Set if the recorded commands of each frame are optimized before they are played
+     * 
+     * The optimizer removes redundant material binds, clears and memory barriers and merges draws of the same material. 
+     * All stages are recorded again after the setting changed. 
+     * 
+     * @param optimize true : the commands are optimized | false : the commands are played as they were recorded
+     */
+    inline void setCommandOptimization(bool optimize) noexcept {m_optimizeCommands.store(optimize, std::memory_order_relaxed); invalidateStages();}
+
+    /**
+     * @brief Get if the recorded commands of each frame are optimized before they are played
+     * 
+     * @return true : the commands are optimized | false : the commands are played as they were recorded
+     */
+    inline bool getCommandOptimization() const noexcept {return m_optimizeCommands.load(std::memory_order_relaxed);}
+
+    /**
+     * @brief Set if memory barriers are inserted automatically
+     * 
+     * The pipeline tracks which buffers each compute object and material writes and which buffers and textures they read. 
+     * Shader storage buffers count as written unless they are marked with `setBufferReadOnly` on the compute object or material. 
+     * A barrier with just the needed bits is inserted only in front of a command that reads or writes data an earlier command wrote. 
+     * Barrier stages are still issued, so full barriers between independent compute stages should be removed when this is enabled. 
+     * Custom stages may access anything, so all pending writes are made visible before them. 
+     * All stages are recorded again after the setting changed. 
+     * 
+     * @param automatic true : barriers are inserted automatically | false : only barrier stages issue barriers
+     */
+    inline void setAutomaticBarriers(bool automatic) noexcept {m_automaticBarriers.store(automatic, std::memory_order_relaxed); invalidateStages();}
+
+    /**
+     * @brief Get if memory barriers are inserted automatically
+     * 
+     * @return true : barriers are inserted automatically | false : only barrier stages issue barriers
+     */
+    inline bool getAutomaticBarriers() const noexcept {return m_automaticBarriers.load(std::memory_order_relaxed);}
+
+    /**
+     * @brief Get the amount of commands the command optimizer removed from the last recorded frame
+     * 
+     * @return uint64_t the amount of removed commands
+     */
+    uint64_t getRemovedCommands() const noexcept;
+
+    /**
+     * @brief Get the amount of draw commands the command optimizer merged in the last recorded frame
+     * 
+     * @return uint64_t the amount of merged draw commands
+     */
+    uint64_t getMergedCommands() const noexcept;
+
     /**
      * @brief Get the Stages of the render pipeline
      * 
@@ -272,7 +401,14 @@ public:
     inline const std::vector<RenderPipelineStage>& getStages() const noexcept {return m_stages;}
 
     /**
-     * @brief record the whole command buffer
+     * @brief record the whole command buffer for the next frame
+     * 
+     * The recording runs on the recording thread of the pipeline. 
+     * If as many frames as allowed are in flight already, the newest frame that was not played yet is recorded again. 
+     * The renderers of all drawn scenes are copied by this call, so scenes may change right after it returns. 
+     * 
+     * @warning all other data the stages use (the stages themselves, render meshes, materials, framebuffers and compute shaders) 
+     *          must not change until `waitForRecording` returns
      */
     void record() noexcept;
 
@@ -283,9 +419,32 @@ public:
 
     /**
      * @brief play the command buffer
+     * 
+     * Once as many frames as allowed are in flight, the oldest one is played (waiting for its recording if needed), so the next frames can be recorded meanwhile. 
+     * Else, the last played frame is played again. 
      */
     void play() noexcept;
 
+    /**
+     * @brief Set how many frames may be in flight at once
+     * 
+     * With a single frame, each call to `play` plays the frame recorded just before. 
+     * With more frames, `play` lags behind `record` by that many frames minus one, so the next frame is recorded while the current one is played. 
+     * 
+     * @warning more frames keep recordings running longer behind the caller. Everything `record` does not copy must still not change 
+     *          until `waitForRecording` returns (see `record`). 
+     * 
+     * @param frames the amount of frames in flight (clamped between 1 and GLGE_MAX_FRAMES_IN_FLIGHT)
+     */
+    void setFramesInFlight(uint8_t frames) noexcept;
+
+    /**
+     * @brief Get how many frames may be in flight at once
+     * 
+     * @return uint8_t the amount of frames in flight
+     */
+    inline uint8_t getFramesInFlight() const noexcept {return m_framesInFlight;}
+
     /**
      * @brief Get the Window the pipeline operates on
      * 
@@ -315,32 +474,37 @@ public:
      */
     inline double getDelta() const noexcept {return m_delta;}
 
-protected:
-
     /**
-     * @brief change the state of the is recording boolean
+     * @brief get how long the last finished recording took
      * 
-     * @param state the new state for the recording
-     */
-    void updateRecordingState(bool state) noexcept;
-
-    /**
-     * @brief wait till the recording state has reached a specific state
+     * The time is measured from the call to `record` until the recording finished, so it includes waking up the recording thread. 
      * 
-     * @param state the state to wait for
+     * @return double the recording time in seconds
      */
-    void waitForRecordingState(bool state) noexcept;
+    inline double getRecordTime() const noexcept {return m_recordTime.load(std::memory_order_relaxed);}
+
+protected:
 
     //initialize the backend API
     void initializeAPI() noexcept;
 
-    //async recording function
-    void asyncRecord() noexcept;
+    //the loop of the recording thread, records every requested frame
+    void recordLoop() noexcept;
 
     //store the stages in the inputted order
     std::vector<RenderPipelineStage> m_stages;
     //store a map of the render pipeline stages to the names
     std::unordered_map<String, uint32_t> m_keyMap;
+    //store the version of each stage
+    //the recording thread reads the versions and settings, so they are atomic
+    //a setting is published by increasing the versions after it was stored
+    std::vector<std::atomic_uint32_t> m_stageVersions;
+    //store if the draws of each frame are sorted
+    std::atomic_bool m_sortDraws{false};
+    //store if the commands of each frame are optimized
+    std::atomic_bool m_optimizeCommands{false};
+    //store if memory barriers are inserted automatically
+    std::atomic_bool m_automaticBarriers{false};
 
     //store the API implementation for the render pipeline
     void* m_api = nullptr;
@@ -350,13 +514,31 @@ protected:
     std::chrono::steady_clock::time_point m_last;
     //store the current delta time
     double m_delta = 0.f;
-    //store the thread for recording
+    //store the thread for recording, it lives as long as the render pipeline
     std::thread m_thread;
+    //store if the recording thread should stop (guarded by m_mut)
+    bool m_stopRecording = false;
+    //store when the recording of each frame slot was requested
+    std::chrono::steady_clock::time_point m_recordStart[GLGE_MAX_FRAMES_IN_FLIGHT];
+    //store the duration of the last finished recording in seconds
+    std::atomic<double> m_recordTime{0.};
     //sync stuff
     std::mutex m_mut;
     std::condition_variable m_cond;
-    //store if the render pipeline is recording
-    std::atomic_bool m_isRecording = false;
+    //the frame counters are guarded by m_mut
+    //the frame n is recorded to the frame slot n % GLGE_MAX_FRAMES_IN_FLIGHT
+    //store the amount of frames that were requested to be recorded
+    uint64_t m_requested = 0;
+    //store the amount of frames that finished recording
+    uint64_t m_recorded = 0;
+    //store the amount of frames that were played
+    uint64_t m_played = 0;
+    //store the frame that is played right now
+    uint64_t m_playingFrame = 0;
+    //store if a frame is played right now
+    bool m_playing = false;
+    //store the amount of frames that may be in flight
+    uint8_t m_framesInFlight = 1;
     //store the window the render pipeline operates on
     ::Window* m_window = nullptr;
 
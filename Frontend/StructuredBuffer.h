@@ -18,6 +18,9 @@
 //only available for C++
 #if __cplusplus
 
+//add spans for mapped regions
+#include <span>
+
 /**
  * @brief define a class that holds a buffer of structures
  * 
@@ -26,6 +29,139 @@
 template <typename T> class StructuredBuffer : public Buffer {
 public:
 
+    /**
+     * @brief a scoped write access to a range of elements
+     * 
+     * The elements can be written in place. All changes are published with a single version bump when the mapping is destroyed. 
+     * 
+     * @warning the thread that holds the mapping must not set or resize the buffer while the mapping exists, 
+     *          as it would wait for its own mapping. 
+     */
+    class Mapping {
+    public:
+
+        /**
+         * @brief Construct a new, empty Mapping
+         */
+        Mapping() = default;
+
+        /**
+         * @brief Construct a new Mapping
+         * 
+         * @param buffer the buffer the elements belong to
+         * @param first the index of the first mapped element
+         * @param count the amount of elements to map
+         */
+        Mapping(StructuredBuffer* buffer, uint64_t first, uint64_t count) noexcept
+         : m_buffer(buffer), m_offset(first*sizeof(T))
+        {
+            //map the elements, an out of bounds range results in an empty mapping
+            T* data = (T*)buffer->Buffer::map(m_offset, count*sizeof(T));
+            if (data) {m_elements = std::span<T>(data, count);}
+            else {m_buffer = nullptr;}
+        }
+
+        /**
+         * @brief Destroy the Mapping and publish the changes
+         */
+        ~Mapping() {unmap();}
+
+        //mappings can't be copied
+        Mapping(const Mapping&) = delete;
+        Mapping& operator=(const Mapping&) = delete;
+
+        /**
+         * @brief move a mapping
+         * 
+         * @param other the mapping to take over
+         */
+        Mapping(Mapping&& other) noexcept
+         : m_buffer(other.m_buffer), m_offset(other.m_offset), m_elements(other.m_elements)
+        {other.m_buffer = nullptr; other.m_elements = {};}
+
+        /**
+         * @brief move a mapping
+         * 
+         * @param other the mapping to take over
+         * @return Mapping& a reference to this mapping
+         */
+        Mapping& operator=(Mapping&& other) noexcept {
+            //publish the own changes first
+            if (this != &other) {
+                unmap();
+                m_buffer = other.m_buffer;
+                m_offset = other.m_offset;
+                m_elements = other.m_elements;
+                other.m_buffer = nullptr;
+                other.m_elements = {};
+            }
+            return *this;
+        }
+
+        /**
+         * @brief publish the changes early, the mapping is empty afterwards
+         */
+        inline void unmap() noexcept {
+            if (m_buffer) {m_buffer->Buffer::unmap(m_offset, m_elements.size_bytes());}
+            m_buffer = nullptr;
+            m_elements = {};
+        }
+
+        /**
+         * @brief Get the mapped elements
+         * 
+         * @return std::span<T> a span of the mapped elements (empty if the mapping failed)
+         */
+        inline std::span<T> span() const noexcept {return m_elements;}
+
+        /**
+         * @brief check if the mapping holds any elements
+         * 
+         * @return true : the elements are mapped
+         * @return false : the mapping is empty
+         */
+        inline explicit operator bool() const noexcept {return m_buffer != nullptr;}
+
+        /**
+         * @brief access a mapped element
+         * 
+         * @param index the index of the element relative to the first mapped element
+         * @return T& a reference to the element
+         */
+        inline T& operator[](uint64_t index) const noexcept {return m_elements[index];}
+
+        /**
+         * @brief Get the amount of mapped elements
+         * 
+         * @return uint64_t the amount of mapped elements
+         */
+        inline uint64_t size() const noexcept {return m_elements.size();}
+
+        /**
+         * @brief get an iterator to the first mapped element
+         * 
+         * @return auto the iterator
+         */
+        inline auto begin() const noexcept {return m_elements.begin();}
+
+        /**
+         * @brief get an iterator behind the last mapped element
+         * 
+         * @return auto the iterator
+         */
+        inline auto end() const noexcept {return m_elements.end();}
+
+    protected:
+
+        //store the buffer the elements belong to
+        StructuredBuffer* m_buffer = nullptr;
+        //store the byte offset of the first element
+        uint64_t m_offset = 0;
+        //store the mapped elements
+        std::span<T> m_elements;
+
+    };
+
     /**
      * @brief Construct a new Structured Buffer
      * 
@@ -64,6 +200,68 @@ public:
     inline void set(uint64_t index, const T& element) noexcept
     {write((void*)&element, index*sizeof(T), sizeof(T));}
 
+    /**
+     * @brief set the values of a contiguous range of elements
+     * 
+     * All elements are written with a single access to the buffer and published as one changed range. 
+     * Nothing is written if the range is out of bounds. 
+     * 
+     * @param first the index of the first element to set
+     * @param elements the values to set the elements to
+     */
+    inline void setRange(uint64_t first, std::span<const T> elements) noexcept {
+        //write all elements to the mapped range
+        T* data = (T*)Buffer::map(first*sizeof(T), elements.size_bytes());
+        if (!data) {return;}
+        for (uint64_t i = 0; i < elements.size(); ++i) {data[i] = elements[i];}
+        Buffer::unmap(first*sizeof(T), elements.size_bytes());
+    }
+
+    /**
+     * @brief set the values of scattered elements
+     * 
+     * All elements are written with a single access to the buffer and published as one changed range that spans from the smallest to the largest index. 
+     * Nothing is written if an index is out of bounds. 
+     * 
+     * @param indices the indices of the elements to set
+     * @param elements the values to set the elements to, one for each index
+     */
+    inline void setIndexed(std::span<const uint64_t> indices, std::span<const T> elements) noexcept {
+        //only complete pairs are written
+        uint64_t count = (indices.size() < elements.size()) ? indices.size() : elements.size();
+        if (count == 0) {return;}
+        //find the range that contains all elements
+        uint64_t first = indices[0];
+        uint64_t last = indices[0];
+        for (uint64_t i = 1; i < count; ++i) {
+            first = (indices[i] < first) ? indices[i] : first;
+            last = (indices[i] > last) ? indices[i] : last;
+        }
+        //write all elements to the mapped range
+        uint64_t offset = first*sizeof(T);
+        uint64_t size = (last - first + 1)*sizeof(T);
+        T* data = (T*)Buffer::map(offset, size);
+        if (!data) {return;}
+        for (uint64_t i = 0; i < count; ++i) {data[indices[i] - first] = elements[i];}
+        Buffer::unmap(offset, size);
+    }
+
+    /**
+     * @brief get write access to a range of elements
+     * 
+     * The elements are written in place instead of being copied into the buffer. 
+     * All changes are published once the returned mapping is destroyed. 
+     * 
+     * @warning the buffer can't be updated for rendering while the mapping exists, so keep it short
+     * @warning the mapping thread must not set or resize the buffer while the mapping exists
+     * 
+     * @param first the index of the first element to map
+     * @param count the amount of elements to map
+     * @return Mapping a scoped mapping of the elements (empty if the range is out of bounds)
+     */
+    inline Mapping map(uint64_t first, uint64_t count) noexcept
+    {return Mapping(this, first, count);}
+
 };
 
 #endif
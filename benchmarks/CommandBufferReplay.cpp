@@ -0,0 +1,126 @@
+/**
+ * @file CommandBufferReplay.cpp
+ * @author DM8AT
+ * @brief measure how long recording and playing a large OpenGL command buffer takes
+ * @version 0.1
+ * @date 2025-10-18
+ * 
+ * @copyright Copyright (c) 2025
+ * 
+ */
+//add the OpenGL command buffer
+#include "../Backend/API_Implementations/OpenGL/OGL_CommandBuffer.h"
+//add the state cache the custom commands reset
+#include "../Backend/API_Implementations/OpenGL/OGL_StateCache.h"
+//add timing
+#include <chrono>
+//add printing
+#include <cstdio>
+//add std::stoul
+#include <string>
+//add vectors for the reference command list
+#include <vector>
+//add placement new
+#include <new>
+
+//use the OpenGL namespace locally
+using namespace GLGE::Graphic::Backend::OGL;
+
+/**
+ * @brief a command of the reference list, commands were stored like this before the command stream
+ * 
+ * Each command is a polymorphic object in a fixed size slot of a vector and is played with a virtual call. 
+ */
+struct ReferenceCommand {
+    //make sure the commands are destroyed correctly
+    virtual ~ReferenceCommand() = default;
+    //run the command
+    virtual void execute() const noexcept = 0;
+};
+
+/**
+ * @brief a reference command that calls back to a function
+ */
+struct ReferenceCustom final : public ReferenceCommand {
+    //store the function and its user data
+    ReferenceCustom(void (*_func)(void*), void* _userData) : func(_func), userData(_userData) {}
+    //run the function, like the custom command this forgets the cached OpenGL state
+    virtual void execute() const noexcept override {func(userData); StateCache::invalidate();}
+    //store the function to call
+    void (*func)(void*);
+    //store the user data to pass to the function
+    void* userData;
+};
+
+/**
+ * @brief a fixed size slot for a single reference command
+ */
+struct ReferenceContainer {
+    //store the command data (large enough for the largest command)
+    alignas(16) std::byte storage[128];
+    //store the command
+    ReferenceCommand* ptr = nullptr;
+    //destroy the command
+    inline void destroy() noexcept {if (ptr) {ptr->~ReferenceCommand();} ptr = nullptr;}
+    ~ReferenceContainer() {destroy();}
+};
+
+/**
+ * @brief the work each command does when it is played
+ * 
+ * @param data a pointer to the counter to increase
+ */
+static void __count(void* data) noexcept {++*(uint64_t*)data;}
+
+int main(int argc, char** argv)
+{
+    //read the settings
+    uint64_t commands = (argc > 1) ? std::stoull(argv[1]) : 100000;
+    uint32_t frames = (argc > 2) ? (uint32_t)std::stoul(argv[2]) : 100;
+
+    //store how often the commands ran, so nothing is optimized away
+    uint64_t counter = 0;
+    double recordTime = 0.;
+    double playTime = 0.;
+    double refRecordTime = 0.;
+    double refPlayTime = 0.;
+
+    //custom commands are the only commands that don't need an OpenGL context to play
+    CommandBuffer cmdBuff;
+    //the slots point into themselves, so they are allocated once and never move
+    std::vector<ReferenceContainer> reference(commands);
+    for (uint32_t f = 0; f < frames; ++f) {
+        //record the frame into the command stream, the memory of the last frame is re-used
+        auto start = std::chrono::steady_clock::now();
+        cmdBuff.clear();
+        for (uint64_t i = 0; i < commands; ++i) {cmdBuff.record<Command_Custom>(&__count, (void*)&counter);}
+        cmdBuff.markRecorded();
+        auto recorded = std::chrono::steady_clock::now();
+        //play the frame
+        cmdBuff.play();
+        auto played = std::chrono::steady_clock::now();
+
+        //do the same with the reference list
+        for (ReferenceContainer& cmd : reference) {
+            cmd.destroy();
+            cmd.ptr = new (cmd.storage) ReferenceCustom(&__count, (void*)&counter);
+        }
+        auto refRecorded = std::chrono::steady_clock::now();
+        for (const ReferenceContainer& cmd : reference) {cmd.ptr->execute();}
+        auto refPlayed = std::chrono::steady_clock::now();
+
+        recordTime += std::chrono::duration<double, std::milli>(recorded - start).count();
+        playTime += std::chrono::duration<double, std::milli>(played - recorded).count();
+        refRecordTime += std::chrono::duration<double, std::milli>(refRecorded - played).count();
+        refPlayTime += std::chrono::duration<double, std::milli>(refPlayed - refRecorded).count();
+    }
+
+    //print the average time per frame
+    printf("%llu commands per frame, %u frames (%llu bytes per frame, %llu commands played)\n", (unsigned long long)commands, frames, 
+           (unsigned long long)cmdBuff.getStreamSize(), (unsigned long long)counter);
+    printf("command stream record: %8.3f ms per frame\n", recordTime / frames);
+    printf("command stream play:   %8.3f ms per frame\n", playTime / frames);
+    printf("reference record:      %8.3f ms per frame\n", refRecordTime / frames);
+    printf("reference play:        %8.3f ms per frame\n", refPlayTime / frames);
+    return 0;
+}
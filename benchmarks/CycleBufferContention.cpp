@@ -0,0 +1,143 @@
+/**
+ * @file CycleBufferContention.cpp
+ * @author DM8AT
+ * @brief compare the write gate of the cycle buffer against a single mutex when many threads write at once
+ * @version 0.1
+ * @date 2025-11-15
+ * 
+ * @copyright Copyright (c) 2025
+ * 
+ */
+//add the cycle buffer
+#include "../Backend/API_Implementations/API_CycleBuffer.h"
+//add threads and timing
+#include <thread>
+#include <chrono>
+#include <mutex>
+//add memcpy
+#include <cstring>
+//add printing
+#include <cstdio>
+//add std::stoul
+#include <string>
+//add std::max
+#include <algorithm>
+//add vectors for the writer threads
+#include <vector>
+
+/**
+ * @brief a buffer that protects all accesses with a single mutex like the cycle buffer did before the write gate
+ */
+class MutexBuffer {
+public:
+
+    /**
+     * @brief Construct a new Mutex Buffer
+     * 
+     * @param size the size of the buffer in bytes
+     */
+    MutexBuffer(uint64_t size) noexcept
+     : m_data(new uint8_t[size]()), m_size(size)
+    {}
+
+    /**
+     * @brief Destroy the Mutex Buffer
+     */
+    ~MutexBuffer() noexcept
+    {delete[] m_data;}
+
+    /**
+     * @brief write the data for a section of the buffer
+     * 
+     * @param data the data to write to the section
+     * @param size the size of the data to write
+     * @param offset the byte offset from the start of the buffer
+     */
+    void write(void* data, uint64_t size, uint64_t offset) noexcept {
+        std::unique_lock lock(m_mtx);
+        memcpy(m_data + offset, data, size);
+        m_version.fetch_add(1, std::memory_order_acq_rel);
+    }
+
+    /**
+     * @brief get exclusive access like a tick or re-size does
+     */
+    void resize(uint64_t) noexcept {
+        std::unique_lock lock(m_mtx);
+        m_version.fetch_add(1, std::memory_order_acq_rel);
+    }
+
+protected:
+
+    //store the raw data
+    uint8_t* m_data = nullptr;
+    //store the size of the buffer
+    uint64_t m_size = 0;
+    //store the mutex that protects the data
+    std::mutex m_mtx;
+    //store the current version
+    std::atomic_uint32_t m_version{0};
+
+};
+
+/**
+ * @brief let multiple threads write disjoint sections of a buffer while another thread takes exclusive access
+ * 
+ * @tparam T the type of buffer to write to
+ * @param buffer the buffer to write to
+ * @param threads the amount of writing threads
+ * @param writes the amount of writes each thread does
+ * @param sectionSize the size of the section each thread writes
+ * @return double the time all writes took in milliseconds
+ */
+template <typename T>
+static double run(T& buffer, uint32_t threads, uint32_t writes, uint64_t sectionSize) noexcept
+{
+    //store if the writers are still running
+    std::atomic_bool running{true};
+    //the exclusive thread re-sizes the buffer to the same size, like a tick that syncs the data
+    std::thread exclusive([&]() {
+        while (running.load(std::memory_order_acquire)) {
+            buffer.resize(sectionSize * threads);
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> writers;
+    for (uint32_t t = 0; t < threads; ++t) {
+        writers.emplace_back([&buffer, t, writes, sectionSize]() {
+            std::vector<uint8_t> data(sectionSize, (uint8_t)t);
+            for (uint32_t i = 0; i < writes; ++i) 
+            {buffer.write(data.data(), sectionSize, t * sectionSize);}
+        });
+    }
+    for (std::thread& writer : writers) {writer.join();}
+    auto end = std::chrono::steady_clock::now();
+
+    running.store(false, std::memory_order_release);
+    exclusive.join();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+int main(int argc, char** argv)
+{
+    //read the settings
+    uint32_t threads = (argc > 1) ? (uint32_t)std::stoul(argv[1]) : std::max(2u, std::thread::hardware_concurrency());
+    uint32_t writes = (argc > 2) ? (uint32_t)std::stoul(argv[2]) : 200000;
+    uint64_t sectionSize = (argc > 3) ? std::stoull(argv[3]) : 64;
+
+    //the cycle buffer only uses its CPU side data here, so no backend is needed
+    GLGE::Graphic::Backend::API::CycleBuffer cycle(nullptr, sectionSize * threads, GLGE::Graphic::Backend::API::Buffer::Type::SHADER_STORAGE_BUFFER, 1);
+    MutexBuffer mutex(sectionSize * threads);
+
+    double gateTime = run(cycle, threads, writes, sectionSize);
+    double mutexTime = run(mutex, threads, writes, sectionSize);
+
+    printf("%u threads, %u writes of %llu bytes each\n", threads, writes, (unsigned long long)sectionSize);
+    printf("write gate: %10.3f ms (%llu waiting writes, %llu waiting exclusive accesses)\n", gateTime, 
+           (unsigned long long)GLGE::Graphic::Backend::API::CycleBuffer::getWriteWaitCount(), 
+           (unsigned long long)GLGE::Graphic::Backend::API::CycleBuffer::getExclusiveWaitCount());
+    printf("mutex:      %10.3f ms\n", mutexTime);
+    return 0;
+}
@@ -0,0 +1,93 @@
+/**
+ * @file StructuredBufferWrites.cpp
+ * @author DM8AT
+ * @brief compare the bulk writes of a structured buffer against setting each element on its own
+ * @version 0.1
+ * @date 2025-11-14
+ * 
+ * @copyright Copyright (c) 2025
+ * 
+ */
+//add structured buffers
+#include "../Frontend/StructuredBuffer.h"
+//add timing
+#include <chrono>
+//add printing
+#include <cstdio>
+//add std::stoul
+#include <string>
+//add vectors for the written elements
+#include <vector>
+
+/**
+ * @brief a typical element of a structured buffer (a transform and some per object data)
+ */
+struct Element {
+    //a 4x4 matrix
+    float transform[16];
+};
+
+/**
+ * @brief measure how long a write function takes
+ * 
+ * @tparam F the type of the write function
+ * @param iterations how often the function is called
+ * @param func the write function
+ * @return double the time all calls took in milliseconds
+ */
+template <typename F>
+static double measure(uint32_t iterations, F&& func) noexcept
+{
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterations; ++i) {func();}
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv)
+{
+    //read the settings
+    uint64_t count = (argc > 1) ? std::stoull(argv[1]) : 4096;
+    uint32_t iterations = (argc > 2) ? (uint32_t)std::stoul(argv[2]) : 1000;
+    //every stride-th element is written by the scattered writes
+    uint64_t stride = (argc > 3) ? std::stoull(argv[3]) : 4;
+
+    //the buffer only uses its CPU side data here, so no backend is needed
+    std::vector<Element> elements(count, Element{{1.f}});
+    StructuredBuffer<Element> buffer(elements.data(), count, GLGE_BUFFER_TYPE_SHADER_STORAGE);
+
+    //the scattered writes
+    std::vector<uint64_t> indices;
+    std::vector<Element> scattered;
+    for (uint64_t i = 0; i < count; i += stride) {
+        indices.push_back(i);
+        scattered.push_back(elements[i]);
+    }
+
+    //write all elements one by one
+    double setTime = measure(iterations, [&]() {
+        for (uint64_t i = 0; i < count; ++i) {buffer.set(i, elements[i]);}
+    });
+    //write all elements at once
+    double rangeTime = measure(iterations, [&]() {
+        buffer.setRange(0, std::span<const Element>(elements));
+    });
+    //write the scattered elements one by one
+    double scatteredSetTime = measure(iterations, [&]() {
+        for (uint64_t i = 0; i < indices.size(); ++i) {buffer.set(indices[i], scattered[i]);}
+    });
+    //write the scattered elements at once
+    double indexedTime = measure(iterations, [&]() {
+        buffer.setIndexed(std::span<const uint64_t>(indices), std::span<const Element>(scattered));
+    });
+
+    //print the time per element
+    double all = (double)count * iterations;
+    double some = (double)indices.size() * iterations;
+    printf("%llu elements of %llu bytes, %u iterations, scattered stride %llu\n", (unsigned long long)count, 
+           (unsigned long long)sizeof(Element), iterations, (unsigned long long)stride);
+    printf("set (all):        %10.3f ms (%8.2f ns per element)\n", setTime, setTime * 1e6 / all);
+    printf("setRange:         %10.3f ms (%8.2f ns per element)\n", rangeTime, rangeTime * 1e6 / all);
+    printf("set (scattered):  %10.3f ms (%8.2f ns per element)\n", scatteredSetTime, scatteredSetTime * 1e6 / some);
+    printf("setIndexed:       %10.3f ms (%8.2f ns per element)\n", indexedTime, indexedTime * 1e6 / some);
+    return 0;
+}